@@ -0,0 +1,139 @@
+#pragma once
+//
+// Copyright 2024 Axel Walthelm
+//
+
+#include <stddef.h>
+#include <vector>
+#include <stdexcept>
+
+// A contour stored in memory owned by somebody else, usually by ContourArena.
+// It can be used as container with FECTS::findContour. Points are written to pre-allocated memory,
+// so tracing does not allocate memory. If the memory is full, std::length_error is thrown.
+//
+// TPoint needs to be copy assignable and constructible by TPoint(int x, int y), e.g. cv::Point.
+template<typename TPoint>
+class ContourSpan
+{
+	TPoint* first = nullptr; // first point
+	TPoint* last = nullptr; // behind last point
+	TPoint* limit = nullptr; // end of available memory
+
+public:
+	ContourSpan() {}
+
+	ContourSpan(TPoint* first, TPoint* last, TPoint* limit) :
+		first(first),
+		last(last),
+		limit(limit)
+	{}
+
+	void emplace_back(int x, int y)
+	{
+		if (last == limit)
+			throw std::length_error("Contour memory is full.");
+		*last++ = TPoint(x, y);
+	}
+
+	size_t size() const { return size_t(last - first); }
+	bool empty() const { return last == first; }
+	TPoint* data() const { return first; }
+	TPoint* begin() const { return first; }
+	TPoint* end() const { return last; }
+	TPoint& operator[](size_t index) const { return first[index]; }
+};
+
+// Memory for many contours which is allocated once and then reused, e.g. for each frame of a video.
+// All points are stored in one flat buffer and contour i starts at offsets[i] (CSR layout).
+// New contours are appended at the end by a bump allocator, so only the contour appended last can grow.
+// clear() takes O(1) and keeps the memory.
+//
+// ContourArena implements the sub-set of std::vector<std::vector<TPoint>> needed by FECTS::findContours,
+// findContoursParallel, and findAllContoursParallel.
+// The number of points needed for one contour is at most FECTS::upperLimitContourLength(width, height).
+// Different contours of an image together have no more points than the image has pixel edges, i.e. 4 * width * height.
+//
+// Example:
+//   ContourArena<cv::Point> arena(FECTS::upperLimitContourLength(width, height));
+//   for (each frame)
+//   {
+//       arena.clear();
+//       arena.emplace_back();
+//       FECTS::findContour(arena.back(), image, start.x, start.y, -1);
+//       for (const cv::Point& point : arena[0])
+//           ...
+//   }
+template<typename TPoint>
+class ContourArena
+{
+	std::vector<TPoint> points; // memory of all points
+	std::vector<size_t> offsets; // index of first point of each contour
+	ContourSpan<TPoint> open; // contour appended last, the only one which can grow
+
+public:
+	typedef ContourSpan<TPoint> value_type;
+
+	explicit ContourArena(size_t point_capacity = 0, size_t contour_capacity = 0)
+	{
+		reserve(point_capacity, contour_capacity);
+	}
+
+	// Make room for given number of points and contours. Existing contours are cleared.
+	void reserve(size_t point_capacity, size_t contour_capacity = 0)
+	{
+		clear();
+		if (point_capacity > points.size())
+			points.resize(point_capacity);
+		offsets.reserve(contour_capacity);
+	}
+
+	// Remove all contours, but keep memory.
+	void clear()
+	{
+		offsets.clear();
+		open = ContourSpan<TPoint>();
+	}
+
+	// Append an empty contour. Points are added by back().emplace_back(x, y).
+	void emplace_back()
+	{
+		const size_t offset = offsets.empty() ? 0 : size_t(open.end() - points.data());
+		offsets.push_back(offset);
+		TPoint* const first = points.data() + offset;
+		open = ContourSpan<TPoint>(first, first, points.data() + points.size());
+	}
+
+	ContourSpan<TPoint>& back()
+	{
+		return open;
+	}
+
+	size_t size() const
+	{
+		return offsets.size();
+	}
+
+	bool empty() const
+	{
+		return offsets.empty();
+	}
+
+	ContourSpan<TPoint> operator[](size_t index) const
+	{
+		if (index + 1 == offsets.size())
+			return open;
+		TPoint* const data = const_cast<TPoint*>(points.data());
+		return ContourSpan<TPoint>(data + offsets[index], data + offsets[index + 1], data + offsets[index + 1]);
+	}
+
+	// Number of points of all contours.
+	size_t point_count() const
+	{
+		return offsets.empty() ? 0 : size_t(open.end() - points.data());
+	}
+
+	size_t point_capacity() const
+	{
+		return points.size();
+	}
+};
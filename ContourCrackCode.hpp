@@ -0,0 +1,193 @@
+#pragma once
+//
+// Copyright 2024 Axel Walthelm
+//
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <vector>
+#include <iterator>
+#include <stdexcept>
+
+// A container that can be used with FECTS::findContour to store a contour as crack code, i.e. as the pixel edges
+// between object and background instead of the pixels. Vertices are pixel corners: corner (x, y) is the top left corner
+// of pixel (x, y). Only the start vertex is stored as (x, y), every edge is stored as the 2 bit direction of the move
+// from its start vertex to the next vertex, packed 32 directions into each 64 bit word.
+// Directions are those of tracing: 0 is up, 1 is right, 2 is down, 3 is left.
+// Vertices are decoded on demand by iterating over the container.
+//
+// The trace loop of findContour passes each edge it travels via emplace_back_edge(x, y, dir), where (x, y) is the
+// corner where the edge starts, so there is no second pass over the pixels. The pixels passed by emplace_back(x, y)
+// are ignored. So border suppression of findContour does not change the result, edges at the image border are always stored.
+// A completely traced contour is a closed polygon, e.g. 4 edges for an isolated pixel, and its area is exact:
+// the area of an outer contour is the number of pixels of the object including its holes.
+// Contours with edges are traced edge by edge, so the lookup table engine, the word engine of the bitonal variant
+// and findContourFramed are not faster for them than the rule code of findContour.
+// findContourFragment and findAllContours do not pass edges.
+//
+// Example:
+//   ContourCrackCode contour;
+//   FECTS::findContour(contour, image, start.x, start.y, -1);
+//   double area = contour.area();
+//   for (const ContourCrackCode::Point& p : contour)
+//       printf("%d %d\n", p.x, p.y);
+class ContourCrackCode
+{
+public:
+	struct Point { int x; int y; };
+
+private:
+	static constexpr int codes_per_word = 32;
+	static constexpr int bits_per_code = 2;
+
+	std::vector<uint64_t> words; // packed directions
+	size_t code_count = 0; // number of edges
+	Point start = { 0, 0 }; // start vertex
+	Point last = { 0, 0 }; // end vertex of last edge
+	int64_t a00 = 0; // twice the signed area without closing segment
+
+	static int dx(int dir)
+	{
+		static constexpr int8_t table[4] = { 0, 1, 0, -1 };
+		return table[dir];
+	}
+
+	static int dy(int dir)
+	{
+		static constexpr int8_t table[4] = { -1, 0, 1, 0 };
+		return table[dir];
+	}
+
+public:
+
+	// Pixels are ignored, see emplace_back_edge.
+	void emplace_back(int, int)
+	{
+	}
+
+	// Add the edge from corner (x, y) in direction dir. It must start where the previous edge ends.
+	void emplace_back_edge(int x, int y, int dir)
+	{
+		if (code_count == 0)
+			start = { x, y };
+		else if (x != last.x || y != last.y)
+			throw std::invalid_argument("Crack code needs connected edges.");
+
+		const size_t word = code_count / codes_per_word;
+		const int shift = int(code_count % codes_per_word) * bits_per_code;
+		if (shift == 0)
+			words.push_back(0);
+		words[word] |= uint64_t(dir) << shift;
+		++code_count;
+
+		last = { x + dx(dir), y + dy(dir) };
+		a00 += int64_t(x) * last.y - int64_t(y) * last.x;
+	}
+
+	void clear()
+	{
+		words.clear();
+		code_count = 0;
+		a00 = 0;
+	}
+
+	bool empty() const
+	{
+		return code_count == 0;
+	}
+
+	// Number of edges, which is the number of vertices of the polygon.
+	size_t size() const
+	{
+		return code_count;
+	}
+
+	// Start vertex.
+	Point front() const
+	{
+		return start;
+	}
+
+	// Indicates if the last edge ends at the start vertex, i.e. the contour is traced completely.
+	bool closed() const
+	{
+		return code_count != 0 && last.x == start.x && last.y == start.y;
+	}
+
+	// Direction of edge i, i.e. of the move from vertex i to vertex i + 1, for i < size().
+	int code(size_t i) const
+	{
+		return int(words[i / codes_per_word] >> (i % codes_per_word * bits_per_code)) & 3;
+	}
+
+	// Number of bytes used by the packed directions.
+	size_t code_bytes() const
+	{
+		return words.size() * sizeof(uint64_t);
+	}
+
+	// Area of the polygon, signed if oriented is true, like ContourArea. If the contour is not closed,
+	// there is an implicit segment from the end of the last edge back to the start vertex.
+	double area(bool oriented = false) const
+	{
+		const double a = double(a00 + int64_t(last.x) * start.y - int64_t(last.y) * start.x) * 0.5;
+		return oriented ? a : fabs(a);
+	}
+
+	// Forward iterator decoding the vertices, i.e. the start of each edge.
+	class const_iterator
+	{
+		const ContourCrackCode* crack;
+		size_t index;
+		Point point;
+
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Point value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const Point* pointer;
+		typedef const Point& reference;
+
+		const_iterator(const ContourCrackCode* crack, size_t index) :
+			crack(crack),
+			index(index),
+			point(crack->start)
+		{}
+
+		reference operator*() const { return point; }
+		pointer operator->() const { return &point; }
+
+		const_iterator& operator++()
+		{
+			if (index < crack->code_count)
+			{
+				const int dir = crack->code(index);
+				point.x += dx(dir);
+				point.y += dy(dir);
+			}
+			++index;
+			return *this;
+		}
+
+		const_iterator operator++(int)
+		{
+			const_iterator old = *this;
+			++*this;
+			return old;
+		}
+
+		bool operator==(const const_iterator& other) const { return index == other.index; }
+		bool operator!=(const const_iterator& other) const { return index != other.index; }
+	};
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, size());
+	}
+};
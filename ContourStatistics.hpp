@@ -0,0 +1,251 @@
+#pragma once
+//
+// Copyright 2024 Axel Walthelm
+//
+
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <algorithm>
+
+// Accumulating containers that can be used with FECTS::findContour to compute shape statistics of a contour
+// on the fly without storing its points. Each one needs O(1) memory.
+// The contour is taken to be closed, i.e. there is an implicit segment from last point back to first point.
+// Results can be queried at any time and are those of the points added so far.
+//
+//   ContourArea: signed and unsigned area like cv::contourArea
+//   ContourPerimeter: perimeter like cv::arcLength(contour, true)
+//   ContourMoments: spatial, central, and normalized central moments up to order 3 like cv::moments
+//   ContourBoundingBox: bounding box like cv::boundingRect
+//
+// Use ContourStatistics to feed several accumulators by one trace.
+//
+// Example:
+//   ContourStatistics<ContourArea, ContourMoments, ContourBoundingBox> statistics;
+//   FECTS::findContour(statistics, image, start.x, start.y, -1);
+//   double area = statistics.area();
+//   ContourMoments::Moments m = statistics.moments();
+//   double center_x = m.m10 / m.m00;
+
+// Helper remembering first and last point of a closed contour.
+class ContourClosing
+{
+protected:
+	struct Point { int x; int y; };
+
+	Point first = { 0, 0 }; // first point
+	Point last = { 0, 0 }; // last point
+	bool is_empty = true; // indicates that there is no point yet
+
+	// Remember point (x, y) and return the previous point in (x0, y0).
+	// Returns false if (x, y) is the first point.
+	bool next(int x, int y, int& x0, int& y0)
+	{
+		x0 = last.x;
+		y0 = last.y;
+		last = { x, y };
+		if (is_empty)
+		{
+			first = last;
+			is_empty = false;
+			return false;
+		}
+		return true;
+	}
+};
+
+// Area enclosed by the contour using the shoelace formula, like cv::contourArea.
+class ContourArea : protected ContourClosing
+{
+	double a00 = 0; // twice the signed area without closing segment
+
+public:
+	void emplace_back(int x, int y)
+	{
+		int x0, y0;
+		if (next(x, y, x0, y0))
+			a00 += double(x0) * y - double(y0) * x;
+	}
+
+	// Area, signed if oriented is true. Like OpenCV it is positive for counterclockwise contours in the mathematical sense,
+	// i.e. for clockwise contours in image coordinates with y pointing down.
+	double area(bool oriented = false) const
+	{
+		const double a = (a00 + double(last.x) * first.y - double(last.y) * first.x) * 0.5;
+		return oriented ? a : fabs(a);
+	}
+};
+
+// Length of the closed contour, like cv::arcLength(contour, true).
+class ContourPerimeter : protected ContourClosing
+{
+	double length = 0; // perimeter without closing segment
+
+	static double distance(int x0, int y0, int x, int y)
+	{
+		// OpenCV computes distances with float
+		const float dx = float(x - x0);
+		const float dy = float(y - y0);
+		return sqrt(dx * dx + dy * dy);
+	}
+
+public:
+	void emplace_back(int x, int y)
+	{
+		int x0, y0;
+		if (next(x, y, x0, y0))
+			length += distance(x0, y0, x, y);
+	}
+
+	double perimeter() const
+	{
+		return is_empty ? 0 : length + distance(last.x, last.y, first.x, first.y);
+	}
+};
+
+// Moments of the area enclosed by the contour computed by Green's theorem, like cv::moments.
+class ContourMoments : protected ContourClosing
+{
+public:
+	// Same members as cv::Moments.
+	struct Moments
+	{
+		// spatial moments
+		double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0, m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+		// central moments
+		double mu20 = 0, mu11 = 0, mu02 = 0, mu30 = 0, mu21 = 0, mu12 = 0, mu03 = 0;
+		// central normalized moments
+		double nu20 = 0, nu11 = 0, nu02 = 0, nu30 = 0, nu21 = 0, nu12 = 0, nu03 = 0;
+	};
+
+private:
+	struct Sums
+	{
+		double a00 = 0, a10 = 0, a01 = 0, a20 = 0, a11 = 0, a02 = 0, a30 = 0, a21 = 0, a12 = 0, a03 = 0;
+
+		void add(double xi_1, double yi_1, double xi, double yi)
+		{
+			const double xi_12 = xi_1 * xi_1;
+			const double yi_12 = yi_1 * yi_1;
+			const double xi2 = xi * xi;
+			const double yi2 = yi * yi;
+			const double dxy = xi_1 * yi - xi * yi_1;
+			const double xii_1 = xi_1 + xi;
+			const double yii_1 = yi_1 + yi;
+
+			a00 += dxy;
+			a10 += dxy * xii_1;
+			a01 += dxy * yii_1;
+			a20 += dxy * (xi_1 * xii_1 + xi2);
+			a11 += dxy * (xi_1 * (yii_1 + yi_1) + xi * (yii_1 + yi));
+			a02 += dxy * (yi_1 * yii_1 + yi2);
+			a30 += dxy * xii_1 * (xi_12 + xi2);
+			a03 += dxy * yii_1 * (yi_12 + yi2);
+			a21 += dxy * (xi_12 * (3 * yi_1 + yi) + 2 * xi * xi_1 * yii_1 + xi2 * (yi_1 + 3 * yi));
+			a12 += dxy * (yi_12 * (3 * xi_1 + xi) + 2 * yi * yi_1 * xii_1 + yi2 * (xi_1 + 3 * xi));
+		}
+	};
+
+	Sums sums; // sums without closing segment
+
+public:
+	void emplace_back(int x, int y)
+	{
+		int x0, y0;
+		if (next(x, y, x0, y0))
+			sums.add(x0, y0, x, y);
+	}
+
+	Moments moments() const
+	{
+		Sums a = sums;
+		a.add(last.x, last.y, first.x, first.y);
+
+		Moments m;
+		if (fabs(a.a00) <= FLT_EPSILON)
+			return m;
+
+		const double sign = a.a00 > 0 ? 1 : -1;
+		m.m00 = a.a00 * sign / 2;
+		m.m10 = a.a10 * sign / 6;
+		m.m01 = a.a01 * sign / 6;
+		m.m20 = a.a20 * sign / 12;
+		m.m11 = a.a11 * sign / 24;
+		m.m02 = a.a02 * sign / 12;
+		m.m30 = a.a30 * sign / 20;
+		m.m21 = a.a21 * sign / 60;
+		m.m12 = a.a12 * sign / 60;
+		m.m03 = a.a03 * sign / 20;
+
+		// central moments
+		double cx = 0, cy = 0, inv_m00 = 0;
+		if (fabs(m.m00) > DBL_EPSILON)
+		{
+			inv_m00 = 1. / m.m00;
+			cx = m.m10 * inv_m00;
+			cy = m.m01 * inv_m00;
+		}
+
+		m.mu20 = m.m20 - m.m10 * cx;
+		m.mu11 = m.m11 - m.m10 * cy;
+		m.mu02 = m.m02 - m.m01 * cy;
+		m.mu30 = m.m30 - cx * (3 * m.mu20 + cx * m.m10);
+		m.mu21 = m.m21 - cx * (2 * m.mu11 + cx * m.m01) - cy * m.mu20;
+		m.mu12 = m.m12 - cy * (2 * m.mu11 + cy * m.m10) - cx * m.mu02;
+		m.mu03 = m.m03 - cy * (3 * m.mu02 + cy * m.m01);
+
+		// central normalized moments
+		const double inv_sqrt_m00 = sqrt(fabs(inv_m00));
+		const double s2 = inv_m00 * inv_m00;
+		const double s3 = s2 * inv_sqrt_m00;
+
+		m.nu20 = m.mu20 * s2;
+		m.nu11 = m.mu11 * s2;
+		m.nu02 = m.mu02 * s2;
+		m.nu30 = m.mu30 * s3;
+		m.nu21 = m.mu21 * s3;
+		m.nu12 = m.mu12 * s3;
+		m.nu03 = m.mu03 * s3;
+
+		return m;
+	}
+};
+
+// Smallest upright rectangle containing all points, like cv::boundingRect.
+class ContourBoundingBox
+{
+	int min_x = INT_MAX, min_y = INT_MAX;
+	int max_x = INT_MIN, max_y = INT_MIN;
+
+public:
+	struct Rect { int x; int y; int width; int height; };
+
+	void emplace_back(int x, int y)
+	{
+		min_x = std::min(min_x, x);
+		min_y = std::min(min_y, y);
+		max_x = std::max(max_x, x);
+		max_y = std::max(max_y, y);
+	}
+
+	// Bounding box with width and height counting pixels; all zero if there are no points.
+	Rect boundingBox() const
+	{
+		if (min_x > max_x)
+			return { 0, 0, 0, 0 };
+		return { min_x, min_y, max_x - min_x + 1, max_y - min_y + 1 };
+	}
+};
+
+// Combination of accumulating containers, each of them gets all points.
+// Results are accessed through the methods of the accumulators, e.g. area() of ContourArea.
+template<typename... TAccumulators>
+class ContourStatistics : public TAccumulators...
+{
+public:
+	void emplace_back(int x, int y)
+	{
+		int unused[] = { 0, (TAccumulators::emplace_back(x, y), 0)... };
+		(void)unused;
+	}
+};
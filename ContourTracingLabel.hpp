@@ -0,0 +1,3773 @@
+#pragma once
+//
+// Copyright 2024 Axel Walthelm
+//
+
+/*
+#############################################################################
+# WARNING: this code was generated - do not edit, your changes may get lost #
+#############################################################################
+Consider to edit Generator\Generator.py and Generator\Template.hpp instead.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <limits.h>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <unordered_set>
+
+// Use SSE2, and AVX2 if the CPU has it, to find the runs of foreground pixels in rows, see findRowRun.
+// Define it 0 to use portable code only.
+#ifndef FECTS_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FECTS_SIMD 1
+#else
+#define FECTS_SIMD 0
+#endif
+#endif
+#if FECTS_SIMD
+#ifdef _MSC_VER
+#include <intrin.h>
+#define FECTS_TARGET_AVX2
+#else
+#include <immintrin.h>
+#define FECTS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifndef FECTS_GENERATOR_OPTIMIZED
+#define FECTS_GENERATOR_OPTIMIZED 1
+#endif
+
+// Use the lookup table engine instead of the rule code in findContour, see findContour<..., LookupTable>.
+#ifndef FECTS_LOOKUP_TABLE_ENGINE
+#define FECTS_LOOKUP_TABLE_ENGINE 0
+#endif
+
+// Count how often each rule of the trace loop of findContour is applied, see ruleProfile.
+#ifndef FECTS_PROFILE_RULES
+#define FECTS_PROFILE_RULES 0
+#endif
+
+// Branch hints of the trace loop if it was generated with a rule profile, see Generator.py --profile.
+#ifndef FECTS_LIKELY
+#if defined(__GNUC__) || defined(__clang__)
+#define FECTS_LIKELY(expr) __builtin_expect(!!(expr), 1)
+#define FECTS_UNLIKELY(expr) __builtin_expect(!!(expr), 0)
+#else
+#define FECTS_LIKELY(expr) (expr)
+#define FECTS_UNLIKELY(expr) (expr)
+#endif
+#endif
+
+/*
+ Fast Edge-Based Contour Tracing from Seed-Point (FECTS)
+============================================================
+
+See README.md at https://github.com/AxelWalthelm/ContourTracing/ for more information.
+
+    Definition of direction
+                                    x    
+    +---------------------------------->  
+    |               (0, -1)               
+    |                  0  up              
+    |                  ^                  
+    |                  |                  
+    |                  |                  
+    | (-1, 0) 3 <------+------> 1 (1, 0)  
+    |       left       |      right       
+    |                  |                  
+    |                  v                  
+    |                  2  down            
+  y |               (0, 1)                
+    v                                     
+
+Tracing contour of 4-connected objects
+----------------------------------------
+
+Generator.py with option --connectivity=4 generates variants for 4-connected foreground objects,
+e.g. ContourTracing4.hpp with namespace FECTS_4 and ContourTracingThresh4.hpp with namespace FECTS_T4.
+Foreground pixels touching only by a corner are not connected then, so the forward-left pixel is only
+connected to the current pixel if the forward pixel is foreground too. For clockwise tracing the rules are:
+	if forward pixel is not foreground
+		turn right
+	else if forward-left pixel is foreground
+		emit current pixel, move to forward-left pixel, turn left
+	else
+		emit current pixel, move ahead
+
+For counterclockwise tracing the rules change in that left is swapped with right.
+Border checks and border suppression are the same as for 8-connected objects.
+The contour line is still 8-connected, i.e. the forward pixel of a left turn is not emitted,
+since it touches the traced background only by a corner.
+findAllContours and findAllContoursParallel are not generated for 4-connected objects,
+since their raster scan labels contours like cv::findContours does for 8-connected objects.
+*/
+
+namespace FECTS_L
+{
+	// Upper limit of contour length is used to prevent infinite loop and out-of-memory crash
+	// if stop criteria is incorrect.
+	// It can also be used to allocate memory to hold contour(s) without further memory
+	// allocations during tracing, see ContourArena.hpp, but note that most contours are significantly shorter.
+	int upperLimitContourLength(int width, int height)
+	{
+		/*
+		How long is the longest 8-connected countour of an 8-connected region?
+		For convex 8-connected regions an upper limit can be as low as 2*(width+height).
+		But doing some examples shows that in general width*height is only a lower limit.
+		Realizing a pixel can be in the contour no more than twice, 2*width*height is an upper limit.
+		It seems that the worst case is a single pixel wide "snake" in the image like this example:
+
+			+-+-+-+-+-+-+-+-+-+
+			|*| |*|*|*| |*|*|*|
+			+-+-+-+-+-+-+-+-+-+
+			|*| |*| |*| |*| |*|
+			+-+-+-+-+-+-+-+-+-+
+			|*| |*| |*| |*| |*|
+			+-+-+-+-+-+-+-+-+-+
+			|*|*|*| |*|*|*| |*|
+			+-+-+-+-+-+-+-+-+-+
+
+		Based on this scheme and assuming it is in fact close to the worst case
+		we use width*heigt+width+height as an upper limit estimate good enough for practical use.
+		*/
+		return width * height + width + height;
+	}
+
+	namespace
+	{
+#ifndef FECTS_Assert
+		void defaultErrorHandler(const char* failed_expression, const char* error_message, const char* function_name, const char* file_name, int line_number)
+		{
+			if (!error_message || !error_message[0])
+				error_message = "FECTS_Assert failed";
+			printf("%s: %s in function %s: %s(%d)\n", error_message, failed_expression, function_name, file_name, line_number);
+			exit(-1);
+		}
+#define FECTS_Assert(expr,msg) do { if(!!(expr)) ; else defaultErrorHandler(#expr, (msg), __func__, __FILE__, __LINE__ ); } while(0)
+#endif
+
+		// Find the first pixel in [x, end) of the row starting at pixels which is foreground if is_foreground is true,
+		// or background otherwise. Returns end if there is none.
+		inline int findRowPixelScalar(const uint8_t* const pixels, int x, const int end, const bool is_foreground, const int label)
+		{
+			for (; x < end; x++)
+			{
+				if ((pixels[x] == label) == is_foreground)
+					return x;
+			}
+			return end;
+		}
+#if FECTS_SIMD
+
+		// Index of lowest set bit, mask must not be 0.
+		static inline
+		int lowestBit(uint32_t mask)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return int(index);
+#else
+			return __builtin_ctz(mask);
+#endif
+		}
+
+		// Like findRowPixelScalar, but comparing 16 pixels at once.
+		inline int findRowPixelSse2(const uint8_t* const pixels, int x, const int end, const bool is_foreground, const int label)
+		{
+			// movemask of pixels == label has bits of foreground pixels; label is in [0, 255]
+			const __m128i labels = _mm_set1_epi8(char(label));
+			const uint32_t flip = is_foreground ? 0 : 0xFFFF;
+			for (; x + 16 <= end; x += 16)
+			{
+				const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+				const uint32_t mask = uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(values, labels))) ^ flip;
+				if (mask != 0)
+					return x + lowestBit(mask);
+			}
+			return findRowPixelScalar(pixels, x, end, is_foreground, label);
+		}
+
+		// Like findRowPixelScalar, but comparing 32 pixels at once.
+		FECTS_TARGET_AVX2
+		inline int findRowPixelAvx2(const uint8_t* const pixels, int x, const int end, const bool is_foreground, const int label)
+		{
+			const __m256i labels = _mm256_set1_epi8(char(label));
+			const uint32_t flip = is_foreground ? 0 : 0xFFFFFFFF;
+			for (; x + 32 <= end; x += 32)
+			{
+				const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + x));
+				const uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(values, labels))) ^ flip;
+				if (mask != 0)
+					return x + lowestBit(mask);
+			}
+			return findRowPixelSse2(pixels, x, end, is_foreground, label);
+		}
+
+		// Indicates if the CPU and the operating system support AVX2, checked once.
+		inline bool hasAvx2()
+		{
+			static const bool has_avx2 = []()
+			{
+#ifdef _MSC_VER
+				int info[4];
+				__cpuid(info, 0);
+				if (info[0] < 7)
+					return false;
+				__cpuid(info, 1);
+				const bool has_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0; // OSXSAVE and AVX
+				if (!has_avx || (_xgetbv(0) & 6) != 6) // XMM and YMM state saved by operating system
+					return false;
+				__cpuidex(info, 7, 0);
+				return (info[1] & (1 << 5)) != 0;
+#else
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2") != 0;
+#endif
+			}();
+			return has_avx2;
+		}
+#endif
+
+		// Find the first pixel in [x, end) of the row starting at pixels which is foreground if is_foreground is true,
+		// or background otherwise, with the fastest implementation for the CPU. Returns end if there is none.
+		inline int findRowPixel(const uint8_t* const pixels, int x, const int end, const bool is_foreground, const int label)
+		{
+			// no pixel is foreground, and the vector code can assume that label is in [0, 255]
+			if (label < 0 || label > 255)
+				return is_foreground ? end : std::min(x, end);
+#if FECTS_SIMD
+			if (hasAvx2())
+				return findRowPixelAvx2(pixels, x, end, is_foreground, label);
+			return findRowPixelSse2(pixels, x, end, is_foreground, label);
+#else
+			return findRowPixelScalar(pixels, x, end, is_foreground, label);
+#endif
+		}
+
+		constexpr int dx[] = {0, 1, 0, -1};
+		constexpr int dy[] = {-1, 0, 1, 0};
+
+		inline bool isForeground(int x, int y, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			return x >= 0 && y >= 0 && x < width && y < height && image[x + y * stride] == label;
+		}
+
+		// Pointer to the first pixel of an image as in findContour, and the stride of the image counted in pixels.
+		template<typename TImage>
+		const uint8_t* imagePointer(int& stride, TImage const& image)
+		{
+			constexpr ptrdiff_t pixel_size = sizeof(uint8_t);
+			const int width = image.cols;
+			const int height = image.rows;
+			const uint8_t* const bytes = image.ptr(0, 0);
+			const ptrdiff_t row_size = height == 1 ? width * pixel_size : image.ptr(1, 0) - bytes;
+			FECTS_Assert(width == 1 || height == 1 || image.ptr(0, 1) - bytes == pixel_size, (row_size == pixel_size ? "image is not row-major order" : "pixel is not 8 bit"));
+			FECTS_Assert(row_size % pixel_size == 0, "row size is not a multiple of pixel size");
+			stride = int(row_size / pixel_size);
+			return reinterpret_cast<const uint8_t*>(bytes);
+		}
+
+		inline int turnLeft(int dir, bool clockwise)
+		{
+			// rules for tracing counterclockwise turn left into right and vice versa
+			return (dir + (clockwise ? 4 - 1 : 1)) & 3;
+		}
+
+		inline int turnRight(int dir, bool clockwise)
+		{
+			// rules for tracing counterclockwise turn left into right and vice versa
+			return turnLeft(dir, !clockwise);
+		}
+
+		inline void moveLeft(int& x, int& y, int dir, bool clockwise)
+		{
+			dir = turnLeft(dir, clockwise);
+			x += dx[dir];
+			y += dy[dir];
+		}
+
+		inline void moveForward(int& x, int& y, int dir)
+		{
+			x += dx[dir];
+			y += dy[dir];
+		}
+
+		inline bool isLeftForeground(int x, int y, int dir, bool clockwise, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			moveLeft(x, y, dir, clockwise);
+			return isForeground(x, y, image, width, height, stride, label);
+		}
+
+		inline bool isLeftForwardForeground(int x, int y, int dir, bool clockwise, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			moveForward(x, y, dir);
+			moveLeft(x, y, dir, clockwise);
+			return isForeground(x, y, image, width, height, stride, label);
+		}
+
+		inline bool isForwardForeground(int x, int y, int dir, bool clockwise, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			moveForward(x, y, dir);
+			return isForeground(x, y, image, width, height, stride, label);
+		}
+
+		// Rule 1 applies if the forward-left pixel is foreground and connected to the current pixel.
+		inline bool isLeftForwardConnected(int x, int y, int dir, bool clockwise, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			return isLeftForwardForeground(x, y, dir, clockwise, image, width, height, stride, label);
+		}
+
+		inline bool isForwardBorder(int x, int y, int dir, int width, int height)
+		{
+			return dir < 2
+				? (dir == 0 ? y == 0 : x == width - 1)
+				: (dir == 2 ? y == height - 1 : x == 0);
+		}
+
+		inline bool isLeftBorder(int x, int y, int dir, bool clockwise, int width, int height)
+		{
+			return isForwardBorder(x, y, turnLeft(dir, clockwise), width, height);
+		}
+
+		// Analyze if the current edge or an earlier contour-edge of the given pixel is not on the image border
+		// by tracing up to 4 steps backward, but only if we stay on the given pixel.
+		inline bool hasPixelNonBorderEdgeBackwards(int x, int y, int dir, bool clockwise, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			// turn around
+			dir = (dir + 2) % 4;
+			clockwise = !clockwise;
+
+			for (int step = 0; step < 4; step++)
+			{
+				// check if current edge is non-border
+				if (!isLeftBorder(x, y, dir, clockwise, width, height))
+					return true;
+
+				// (rule 1)
+				if (isLeftForwardConnected(x, y, dir, clockwise, image, width, height, stride, label))
+				{
+					break; // next contour edge is on a different pixel
+				}
+				// (rule 2)
+				else if (isForwardForeground(x, y, dir, clockwise, image, width, height, stride, label))
+				{
+					break; // next contour edge is on a different pixel
+				}
+				// (rule 3)
+				else
+				{
+					dir = turnRight(dir, clockwise);
+				}
+			}
+
+			return false;
+		}
+
+		// Step of the lookup table engine.
+		struct lookup_step_t
+		{
+			int8_t dir; // next direction
+			int8_t dx; // move of current pixel
+			int8_t dy;
+			int8_t rule; // rule 1 and 2 emit the current pixel and move, rule 3 only turns
+			int8_t turn; // -1 for left turn, 1 for right turn
+		};
+
+		// Steps of the lookup table engine indexed by [clockwise][dir * 4 + forward-left pixel * 2 + forward pixel]
+		// where pixels are 1 if foreground and 0 if background or outside of the image.
+		// The table is generated from the same rules as the trace loop.
+		constexpr lookup_step_t lookup_steps[2][16] =
+		{
+			// counterclockwise
+			{
+			    { 3,  0,  0, 3,  1 }, // dir 0, forward-right 0, forward 0
+			    { 0,  0, -1, 2,  0 }, // dir 0, forward-right 0, forward 1
+			    { 1,  1, -1, 1, -1 }, // dir 0, forward-right 1, forward 0
+			    { 1,  1, -1, 1, -1 }, // dir 0, forward-right 1, forward 1
+			    { 0,  0,  0, 3,  1 }, // dir 1, forward-right 0, forward 0
+			    { 1,  1,  0, 2,  0 }, // dir 1, forward-right 0, forward 1
+			    { 2,  1,  1, 1, -1 }, // dir 1, forward-right 1, forward 0
+			    { 2,  1,  1, 1, -1 }, // dir 1, forward-right 1, forward 1
+			    { 1,  0,  0, 3,  1 }, // dir 2, forward-right 0, forward 0
+			    { 2,  0,  1, 2,  0 }, // dir 2, forward-right 0, forward 1
+			    { 3, -1,  1, 1, -1 }, // dir 2, forward-right 1, forward 0
+			    { 3, -1,  1, 1, -1 }, // dir 2, forward-right 1, forward 1
+			    { 2,  0,  0, 3,  1 }, // dir 3, forward-right 0, forward 0
+			    { 3, -1,  0, 2,  0 }, // dir 3, forward-right 0, forward 1
+			    { 0, -1, -1, 1, -1 }, // dir 3, forward-right 1, forward 0
+			    { 0, -1, -1, 1, -1 }, // dir 3, forward-right 1, forward 1
+			},
+			// clockwise
+			{
+			    { 1,  0,  0, 3,  1 }, // dir 0, forward-left 0, forward 0
+			    { 0,  0, -1, 2,  0 }, // dir 0, forward-left 0, forward 1
+			    { 3, -1, -1, 1, -1 }, // dir 0, forward-left 1, forward 0
+			    { 3, -1, -1, 1, -1 }, // dir 0, forward-left 1, forward 1
+			    { 2,  0,  0, 3,  1 }, // dir 1, forward-left 0, forward 0
+			    { 1,  1,  0, 2,  0 }, // dir 1, forward-left 0, forward 1
+			    { 0,  1, -1, 1, -1 }, // dir 1, forward-left 1, forward 0
+			    { 0,  1, -1, 1, -1 }, // dir 1, forward-left 1, forward 1
+			    { 3,  0,  0, 3,  1 }, // dir 2, forward-left 0, forward 0
+			    { 2,  0,  1, 2,  0 }, // dir 2, forward-left 0, forward 1
+			    { 1,  1,  1, 1, -1 }, // dir 2, forward-left 1, forward 0
+			    { 1,  1,  1, 1, -1 }, // dir 2, forward-left 1, forward 1
+			    { 0,  0,  0, 3,  1 }, // dir 3, forward-left 0, forward 0
+			    { 3, -1,  0, 2,  0 }, // dir 3, forward-left 0, forward 1
+			    { 2, -1,  1, 1, -1 }, // dir 3, forward-left 1, forward 0
+			    { 2, -1,  1, 1, -1 }, // dir 3, forward-left 1, forward 1
+			},
+		};
+
+		// Step of the lookup table engine over all edges of one pixel, i.e. the rule 3 turns on the pixel
+		// followed by the rule 1 or 2 step which leaves it.
+		struct pixel_step_t
+		{
+			int8_t dx; // move to next pixel
+			int8_t dy;
+			int8_t dir; // direction at next pixel
+			int8_t turn; // sum of turns
+			uint8_t visited; // bit d is set if the edge with direction d of the pixel is travelled
+			uint8_t rule; // rule of the step which leaves the pixel
+		};
+
+		typedef pixel_step_t pixel_steps_t[2][4 * 256];
+
+		// Steps of the lookup table engine indexed by [clockwise][dir * 256 + neighbourhood] where bit i of neighbourhood
+		// is 1 if the i-th of the 8 neighbours in row-major order is foreground.
+		// The table is built from lookup_steps on first use.
+		inline const pixel_steps_t& pixelSteps()
+		{
+			static const struct table_t
+			{
+				pixel_steps_t steps;
+
+				table_t()
+				{
+					for (int c = 0; c < 2; c++)
+					{
+						for (int start_dir = 0; start_dir < 4; start_dir++)
+						{
+							for (int neighbourhood = 0; neighbourhood < 256; neighbourhood++)
+							{
+								// isolated pixels have no step leaving them, but they are never traced with this table
+								pixel_step_t& step = steps[c][start_dir * 256 + neighbourhood];
+								step = pixel_step_t{ 0, 0, 0, 0, 0, 3 };
+								int dir = start_dir;
+								for (int i = 0; i < 4 && step.rule == 3; i++)
+								{
+									const int left = turnLeft(dir, c != 0);
+									const int forward = neighbourBit(neighbourhood, dx[dir], dy[dir]);
+									const int forward_left = neighbourBit(neighbourhood, dx[dir] + dx[left], dy[dir] + dy[left]);
+									const lookup_step_t& edge_step = lookup_steps[c][dir * 4 + forward_left * 2 + forward];
+									step.visited |= uint8_t(1 << dir);
+									step.turn += edge_step.turn;
+									step.dx = edge_step.dx;
+									step.dy = edge_step.dy;
+									step.rule = edge_step.rule;
+									dir = edge_step.dir;
+								}
+								step.dir = int8_t(dir);
+							}
+						}
+					}
+				}
+
+				static int neighbourBit(int neighbourhood, int dx, int dy)
+				{
+					const int i = (dy + 1) * 3 + dx + 1;
+					return (neighbourhood >> (i < 4 ? i : i - 1)) & 1;
+				}
+			} table;
+
+			return table.steps;
+		}
+
+		// Pass the contour edge (x, y, dir) to contours which store edges instead of pixels, e.g. ContourCrackCode.
+		// The edge is passed as the pixel corner where it starts and its direction, so the contour gets one move
+		// from corner to corner per edge, and the end of an edge is the start of the next one.
+		// Directions are those of tracing: 0 is up, 1 is right, 2 is down, 3 is left.
+		// Returns std::true_type, the overload for other contours returns std::false_type, see HasEdgeOutput.
+		template<typename TContour>
+		inline auto emplaceBackEdge(TContour& contour, int x, int y, int dir, bool clockwise, int) -> decltype(contour.emplace_back_edge(x, y, dir), std::true_type())
+		{
+			// offsets of the start corner for each direction, the edge is on the left side of the pixel
+			static constexpr int8_t corners[2][4][2] =
+			{
+				{ { 1, 1 }, { 0, 1 }, { 0, 0 }, { 1, 0 } }, // counterclockwise
+				{ { 0, 1 }, { 0, 0 }, { 1, 0 }, { 1, 1 } }  // clockwise
+			};
+			contour.emplace_back_edge(x + corners[clockwise][dir][0], y + corners[clockwise][dir][1], dir);
+			return std::true_type();
+		}
+
+		template<typename TContour>
+		inline std::false_type emplaceBackEdge(TContour&, int, int, int, bool, long)
+		{
+			return std::false_type();
+		}
+
+		template<typename TContour>
+		inline void emplaceBackEdge(TContour& contour, int x, int y, int dir, bool clockwise)
+		{
+			emplaceBackEdge(contour, x, y, dir, clockwise, 0);
+		}
+
+		// Indicates if contour takes the edges, i.e. if it implements emplace_back_edge(x, y, dir).
+		// Trace loops which skip over several edges at once use it to fall back to edge by edge tracing.
+		template<typename TContour>
+		struct HasEdgeOutput : decltype(emplaceBackEdge(std::declval<TContour&>(), 0, 0, 0, false, 0)) {};
+
+		// Trace loop of findContour using lookup tables. Instead of a tree of branches on direction and pixels,
+		// the 8 neighbours of the current pixel are read without branches and combined with the direction
+		// to one index into pixelSteps, which gives the next pixel and direction and everything else needed.
+		// So there is one data dependent load per contour pixel instead of one unpredictable branch per edge.
+		// Pixels at the image border and the start and stop pixel, where the trace may stop on any edge,
+		// are stepped edge by edge with lookup_steps, reading the two pixels in front of the current edge.
+		// So are all pixels if the contour takes the edges, see HasEdgeOutput.
+		// Returns the sum of turns.
+		template<bool Clockwise, bool SuppressBorder, bool HasStop, bool HasLengthLimit, bool HasStopPredicate, typename TContour, typename TStopPredicate>
+		int traceLookupTable(TContour& contour, const uint8_t* const image, const int width, const int height, const int stride, const int label, int& x, int& y, int& dir, bool& is_pixel_valid,
+			int& contour_length, int max_contour_length, int start_x, int start_y, int start_dir, int stop_x, int stop_y, int stop_dir, uint8_t* visited,
+			TStopPredicate& stop_predicate, int& stop_reason)
+		{
+			const lookup_step_t* const steps = lookup_steps[Clockwise ? 1 : 0];
+			const pixel_step_t* const pixel_steps = pixelSteps()[Clockwise ? 1 : 0];
+
+			// offsets of forward and forward-left pixel for each direction, and offset of the current pixel for each step
+			int forward_offsets[4];
+			int forward_left_offsets[4];
+			for (int d = 0; d < 4; d++)
+			{
+				const int left = turnLeft(d, Clockwise);
+				forward_offsets[d] = dx[d] + dy[d] * stride;
+				forward_left_offsets[d] = forward_offsets[d] + dx[left] + dy[left] * stride;
+			}
+			int step_offsets[16];
+			for (int i = 0; i < 16; i++)
+				step_offsets[i] = steps[i].dx + steps[i].dy * stride;
+
+			const int width_m1 = width - 1;
+			const int height_m1 = height - 1;
+			const int start_pixel = start_x + start_y * stride;
+			const int stop_pixel = stop_x + stop_y * stride;
+			int pixel = x + y * stride;
+			int sum_of_turns = 0;
+			constexpr bool has_edge_output = HasEdgeOutput<TContour>::value;
+
+			do
+			{
+				if (!has_edge_output && unsigned(x - 1) < unsigned(width - 2) && unsigned(y - 1) < unsigned(height - 2) &&
+					pixel != start_pixel && (!HasStop || pixel != stop_pixel))
+				{
+					// inner pixel, leave it with one step; it is always valid
+					const int neighbourhood =
+						int(image[pixel - stride - 1] == label) | int(image[pixel - stride] == label) << 1 |
+						int(image[pixel - stride + 1] == label) << 2 | int(image[pixel - 1] == label) << 3 |
+						int(image[pixel + 1] == label) << 4 | int(image[pixel + stride - 1] == label) << 5 |
+						int(image[pixel + stride] == label) << 6 | int(image[pixel + stride + 1] == label) << 7;
+
+					const pixel_step_t step = pixel_steps[dir * 256 + neighbourhood];
+					if (visited != NULL)
+						visited[pixel] |= step.visited;
+					contour.emplace_back(x, y);
+					pixel += step.dx + step.dy * stride;
+					x += step.dx;
+					y += step.dy;
+					dir = step.dir;
+					sum_of_turns += step.turn;
+					++contour_length;
+					if (SuppressBorder)
+						is_pixel_valid = step.rule == 1 || !isLeftBorder(x, y, dir, Clockwise, width, height);
+					if (HasLengthLimit && contour_length >= max_contour_length)
+						break;
+					if (HasStopPredicate && (stop_reason = stop_predicate(x, y)) != 0)
+						break;
+					continue;
+				}
+
+				if (visited != NULL)
+					visited[pixel] |= uint8_t(1 << dir);
+				if (has_edge_output)
+					emplaceBackEdge(contour, x, y, dir, Clockwise);
+
+				// bit d is set if the neighbour in direction d is inside of the image;
+				// offsets of pixels outside of the image are masked to read the current pixel instead
+				const int inside = int(y != 0) | int(x != width_m1) << 1 | int(y != height_m1) << 2 | int(x != 0) << 3;
+				const int is_forward_inside = (inside >> dir) & 1;
+				const int is_forward_left_inside = is_forward_inside & (inside >> turnLeft(dir, Clockwise));
+				const int forward = is_forward_inside & int(image[pixel + (forward_offsets[dir] & -is_forward_inside)] == label);
+				const int forward_left = is_forward_left_inside & int(image[pixel + (forward_left_offsets[dir] & -is_forward_left_inside)] == label);
+
+				const int index = dir * 4 + forward_left * 2 + forward;
+				const lookup_step_t step = steps[index];
+				if (step.rule == 1 || (step.rule == 2 && (!SuppressBorder || is_pixel_valid)))
+					contour.emplace_back(x, y);
+				pixel += step_offsets[index];
+				x += step.dx;
+				y += step.dy;
+				dir = step.dir;
+				sum_of_turns += step.turn;
+				contour_length += int(step.rule != 3);
+				if (SuppressBorder)
+				{
+					if (step.rule == 1)
+						is_pixel_valid = true;
+					else if (step.rule == 2 || !is_pixel_valid)
+						is_pixel_valid = !isLeftBorder(x, y, dir, Clockwise, width, height);
+				}
+				if (HasLengthLimit && contour_length >= max_contour_length)
+					break;
+				if (HasStopPredicate && step.rule != 3 && (stop_reason = stop_predicate(x, y)) != 0)
+					break;
+			} while ((x != start_x || y != start_y || dir != start_dir)
+			         && (!HasStop || x != stop_x || y != stop_y || dir != stop_dir));
+
+			return sum_of_turns;
+		}
+
+		// Emit pixel (x, y) and pass the chain code of the move that follows to contours which can use it, e.g. ContourChainCode.
+		// The generated trace loop knows the move in each branch, so the contour does not need to compute it.
+		// Chain codes are as used by OpenCV: 0 is right, 2 is up, 4 is left, 6 is down.
+		template<typename TContour>
+		inline auto emplaceBackMove(TContour& contour, int x, int y, int code, int) -> decltype(contour.emplace_back_move(x, y, code))
+		{
+			return contour.emplace_back_move(x, y, code);
+		}
+
+		template<typename TContour>
+		inline void emplaceBackMove(TContour& contour, int x, int y, int, long)
+		{
+			contour.emplace_back(x, y);
+		}
+
+		template<typename TContour>
+		inline void emplaceBackMove(TContour& contour, int x, int y, int code)
+		{
+			emplaceBackMove(contour, x, y, code, 0);
+		}
+
+		// Emit pixel with index x + y * stride, for trace loops that do not track x and y.
+		template<typename TContour>
+		inline void emplaceBackIndex(TContour& contour, size_t index, int stride)
+		{
+			const unsigned y = unsigned(index) / unsigned(stride);
+			contour.emplace_back(int(unsigned(index) - y * unsigned(stride)), int(y));
+		}
+
+		// Contour container adapter used by findAllContours to label contour pixels like Suzuki's border following does,
+		// i.e. like OpenCV cv::findContours does.
+		// A pixel gets label -nbd if the pixel to its right is background and it is examined while following the border.
+		// Otherwise the pixel gets label +nbd, but only if it has no label yet.
+		// Whether the right pixel is examined depends on previous and next contour pixel, so labeling is done one pixel late
+		// and the first and last pixel are labeled in close().
+		template<typename TContour>
+		class LabelingContour
+		{
+			TContour& contour;
+			int* const labels;
+			const int labels_stride;
+			const int nbd;
+			int count = 0;
+			int first_x = 0, first_y = 0;
+			int second_x = 0, second_y = 0;
+			int previous_x = 0, previous_y = 0;
+			int last_x = 0, last_y = 0;
+
+			// chain code as used by OpenCV: 0 is right, 2 is up, 4 is left, 6 is down
+			static int chainCode(int dx, int dy)
+			{
+				static constexpr int codes[9] = { 3, 2, 1, 4, -1, 0, 5, 6, 7 };
+				return codes[(dy + 1) * 3 + dx + 1];
+			}
+
+			void label(int x, int y, int from_x, int from_y, int to_x, int to_y)
+			{
+				// neighbours are examined counterclockwise starting after the previous pixel and ending at the next pixel
+				const int s_end = chainCode(from_x - x, from_y - y);
+				const int s = chainCode(to_x - x, to_y - y);
+				int& l = labels[x + y * labels_stride];
+				if ((unsigned)(s - 1) < (unsigned)s_end)
+					l = -nbd;
+				else if (l == 0)
+					l = nbd;
+			}
+
+		public:
+			LabelingContour(TContour& contour, int* labels, int labels_stride, int nbd) :
+				contour(contour),
+				labels(labels),
+				labels_stride(labels_stride),
+				nbd(nbd)
+			{}
+
+			void emplace_back(int x, int y)
+			{
+				contour.emplace_back(x, y);
+
+				if (count == 0)
+				{
+					first_x = x;
+					first_y = y;
+				}
+				else if (count == 1)
+				{
+					second_x = x;
+					second_y = y;
+				}
+				else
+				{
+					label(last_x, last_y, previous_x, previous_y, x, y);
+				}
+
+				previous_x = last_x;
+				previous_y = last_y;
+				last_x = x;
+				last_y = y;
+				++count;
+			}
+
+			void close()
+			{
+				if (count == 1)
+				{
+					// single isolated pixel, all neighbours are examined
+					labels[first_x + first_y * labels_stride] = -nbd;
+				}
+				else if (count > 1)
+				{
+					label(last_x, last_y, previous_x, previous_y, first_x, first_y);
+					label(first_x, first_y, last_x, last_y, second_x, second_y);
+				}
+				count = 0;
+			}
+		};
+
+		// Contour container that ignores all points.
+		struct NoContour
+		{
+			void emplace_back(int, int) {}
+		};
+
+		// Contour container adapter used by findContours to find the seeds that are on the traced contour.
+		// Bits 0 to 3 of visited are set by findContour for each edge (x, y, dir) travelled,
+		// bits 4 to 7 mark start edges of seeds which have no contour yet.
+		// A pixel is emitted when tracing leaves it, so by then all its edges travelled so far are marked.
+		// The start pixel is visited again at the end of the contour without being emitted, so close() needs to check it.
+		template<typename TContour, typename TResolve>
+		class SeedResolvingContour
+		{
+			TContour& contour;
+			uint8_t* const visited;
+			const int stride;
+			TResolve& resolve;
+
+			void check(int x, int y)
+			{
+				uint8_t& v = visited[x + y * stride];
+				const int travelled_seeds = (v >> 4) & v;
+				if (travelled_seeds != 0)
+				{
+					v &= uint8_t(~(travelled_seeds << 4));
+					for (int dir = 0; dir < 4; dir++)
+					{
+						if (travelled_seeds & (1 << dir))
+							resolve(x, y, dir);
+					}
+				}
+			}
+
+		public:
+			SeedResolvingContour(TContour& contour, uint8_t* visited, int stride, TResolve& resolve) :
+				contour(contour),
+				visited(visited),
+				stride(stride),
+				resolve(resolve)
+			{}
+
+			void emplace_back(int x, int y)
+			{
+				contour.emplace_back(x, y);
+				check(x, y);
+			}
+
+			void close(int start_x, int start_y)
+			{
+				check(start_x, start_y);
+			}
+		};
+
+		// Contour container appending x and y of all points to one flat buffer.
+		struct FlatContour
+		{
+			std::vector<int>& buffer;
+
+			void emplace_back(int x, int y)
+			{
+				buffer.push_back(x);
+				buffer.push_back(y);
+			}
+		};
+
+		// Range of work items [begin, end) packed into one word, so it can be shared lock-free by owner and thieves.
+		inline uint64_t packRange(int begin, int end)
+		{
+			return (uint64_t(uint32_t(begin)) << 32) | uint32_t(end);
+		}
+
+		inline int rangeBegin(uint64_t range)
+		{
+			return int(range >> 32);
+		}
+
+		inline int rangeEnd(uint64_t range)
+		{
+			return int(uint32_t(range));
+		}
+
+		// Take the first item of own range.
+		inline bool popItem(std::atomic<uint64_t>& own_range, int& item)
+		{
+			uint64_t range = own_range.load();
+			while (rangeBegin(range) < rangeEnd(range))
+			{
+				if (own_range.compare_exchange_weak(range, packRange(rangeBegin(range) + 1, rangeEnd(range))))
+				{
+					item = rangeBegin(range);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Take the second half of the range of another worker, keep the rest of it as own range, and return its first item.
+		inline bool stealItem(std::vector<std::atomic<uint64_t>>& ranges, int thief, int& item)
+		{
+			const int count = int(ranges.size());
+			for (int i = 1; i < count; i++)
+			{
+				std::atomic<uint64_t>& victim_range = ranges[(thief + i) % count];
+				uint64_t range = victim_range.load();
+				while (rangeBegin(range) < rangeEnd(range))
+				{
+					const int begin = rangeBegin(range);
+					const int end = rangeEnd(range);
+					const int middle = end - std::max(1, (end - begin) / 2);
+					if (victim_range.compare_exchange_weak(range, packRange(begin, middle)))
+					{
+						ranges[thief].store(packRange(middle + 1, end));
+						item = middle;
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+
+		// Key of a contour edge where Suzuki's raster scan may start a contour when tracing counterclockwise:
+		// outer contours start at an edge with direction 2, holes at an edge with direction 0.
+		// The edge with the smallest key of a contour is the edge where cv::findContours starts it.
+		inline int64_t rasterStartKey(int x, int y, int dir, int width)
+		{
+			return (int64_t(y) * width + x) * 2 + (dir == 0 ? 1 : 0);
+		}
+
+		// Row of the pixel of the previous contour edge when tracing counterclockwise,
+		// found by tracing one step backward like hasPixelNonBorderEdgeBackwards does.
+		inline int previousContourRow(int x, int y, int dir, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			// turn around
+			dir = (dir + 2) % 4;
+
+			// (rule 1)
+			if (isLeftForwardForeground(x, y, dir, true, image, width, height, stride, label))
+				return y + dy[dir] + dy[turnLeft(dir, true)];
+			// (rule 2)
+			else if (isForwardForeground(x, y, dir, true, image, width, height, stride, label))
+				return y + dy[dir];
+			// (rule 3)
+			else
+				return y;
+		}
+
+		// Trace a contour counterclockwise without border suppression like the generic loop of findContour does,
+		// but only while it stays in the rows [y_begin, y_end) of a band.
+		// Returns the number of emitted points.
+		// @param x, y, dir In: edge where the contour enters the band. Out: first edge outside of the band,
+		// i.e. the edge where the contour enters the next band.
+		// @param first_start In/out: smallest rasterStartKey of edges travelled so far.
+		// @param first_start_index Out: number of points emitted before the edge of first_start, if it is updated.
+		template<typename TContour>
+		int traceBand(TContour& contour, int& x, int& y, int& dir, int y_begin, int y_end, uint8_t* visited, int64_t& first_start, int& first_start_index, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			int contour_length = 0;
+			const int max_contour_length = upperLimitContourLength(width, height);
+
+			for (;;)
+			{
+				visited[x + y * stride] |= uint8_t(1 << dir);
+				if ((dir & 1) == 0)
+				{
+					const int64_t start = rasterStartKey(x, y, dir, width);
+					if (start < first_start)
+					{
+						first_start = start;
+						first_start_index = contour_length;
+					}
+				}
+
+				// (rule 1)
+				if (isLeftForwardForeground(x, y, dir, false, image, width, height, stride, label))
+				{
+					contour.emplace_back(x, y);
+					moveForward(x, y, dir);
+					moveLeft(x, y, dir, false);
+					dir = turnLeft(dir, false);
+				}
+				// (rule 2)
+				else if (isForwardForeground(x, y, dir, false, image, width, height, stride, label))
+				{
+					contour.emplace_back(x, y);
+					moveForward(x, y, dir);
+				}
+				// (rule 3)
+				else
+				{
+					dir = turnRight(dir, false);
+					continue;
+				}
+
+				++contour_length;
+				if (y < y_begin || y >= y_end)
+					break;
+				FECTS_Assert(contour_length < max_contour_length, "contour fragment does not leave its band");
+			}
+
+			return contour_length;
+		}
+
+	} // namespace
+
+	// Reasons why tracing stopped, see stop_t::reason.
+	enum stop_reason_t
+	{
+		STOP_CLOSED = 0, // contour is traced completely, i.e. tracing returned to the start edge
+		STOP_AT_POSITION = 1, // stop position is reached
+		STOP_AT_LENGTH = 2, // maximum contour length is reached
+		STOP_AT_BOUNDING_BOX = 3, // bounding box exceeds its limits, see StopAtBoundingBox
+		STOP_AT_BORDER = 4, // image border is reached, see StopAtBorder
+		STOP_OUTSIDE_RECTANGLE = 5, // contour leaves a rectangle, see StopOutsideRectangle
+		STOP_USER = 16, // first reason free for other stop predicates
+	};
+
+	struct stop_t
+	{
+		// Usually the full contour is traced.
+		// Sometimes it is useful to limit the length of the contour, e.g. to limit time and memory usage.
+		// Set it to zero to only do startup logic like choosing a valid start direction.
+		// In: if >= 0 then the maximum allowed contour length
+		// Out: number of traced contour pixels including suppressed pixels
+		int max_contour_length = -1;
+
+		// Usually tracing stops when the start position is reached.
+		// Sometimes it is useful to stop at another known position on the contour.
+		// In: if dir is a valid direction 0-3 then (x, y, dir) becomes an additional position to stop tracing
+		// Out: (x, y, dir) is the position tracing stopped, e.g. because maximum contour length was reached
+		int dir = -1;
+		int x;
+		int y;
+
+		// Out: why tracing stopped, see stop_reason_t, or the non-zero value returned by the stop predicate.
+		int reason = STOP_CLOSED;
+	};
+
+	// Stop predicates of findContour.
+	// A stop predicate is called for each pixel tracing moves to, including the start pixel before tracing starts,
+	// so each contour pixel is checked before it is emitted. It returns 0 to continue tracing, otherwise the reason to stop.
+	// Each pixel is checked as soon as it is reached, so rejected contours cost only the pixels traced up to there.
+	// Other stop predicates just need int operator()(int x, int y), e.g. a lambda; use reasons from STOP_USER on.
+	// The type is a template parameter of findContour, so the check is compiled into the trace loop.
+
+	// Stop predicate that never stops, the default of findContour. It is removed at compile time.
+	struct NoStopPredicate
+	{
+		int operator()(int, int) const { return 0; }
+	};
+
+	// Stop if the bounding box of the pixels traced so far becomes wider than max_width or higher than max_height.
+	struct StopAtBoundingBox
+	{
+		int max_width;
+		int max_height;
+		int min_x = INT_MAX, min_y = INT_MAX;
+		int max_x = INT_MIN, max_y = INT_MIN;
+
+		StopAtBoundingBox(int max_width, int max_height) : max_width(max_width), max_height(max_height) {}
+
+		int operator()(int x, int y)
+		{
+			min_x = std::min(min_x, x);
+			max_x = std::max(max_x, x);
+			min_y = std::min(min_y, y);
+			max_y = std::max(max_y, y);
+			return max_x - min_x >= max_width || max_y - min_y >= max_height ? STOP_AT_BOUNDING_BOX : 0;
+		}
+	};
+
+	// Stop if a pixel in the first or last row or column of the image is reached.
+	struct StopAtBorder
+	{
+		int width;
+		int height;
+
+		StopAtBorder(int width, int height) : width(width), height(height) {}
+
+		int operator()(int x, int y) const
+		{
+			return unsigned(x - 1) >= unsigned(width - 2) || unsigned(y - 1) >= unsigned(height - 2) ? STOP_AT_BORDER : 0;
+		}
+	};
+
+	// Stop if a pixel outside of the rectangle with top left pixel (x, y) and size width, height is reached, e.g. a region of interest.
+	struct StopOutsideRectangle
+	{
+		int x;
+		int y;
+		int width;
+		int height;
+
+		StopOutsideRectangle(int x, int y, int width, int height) : x(x), y(y), width(width), height(height) {}
+
+		int operator()(int pixel_x, int pixel_y) const
+		{
+			return unsigned(pixel_x - x) >= unsigned(width) || unsigned(pixel_y - y) >= unsigned(height) ? STOP_OUTSIDE_RECTANGLE : 0;
+		}
+	};
+
+	// Number of times each rule of the trace loop of findContour was applied,
+	// indexed by [clockwise][dir][rule] with rules 0 to 3 as described in the generated code.
+	// Rule 0 (forward is border) only exists in the optimized code, see FECTS_GENERATOR_OPTIMIZED.
+	// Steps of the lookup table engine and of findContourFramed are not counted.
+	struct rule_profile_t
+	{
+		uint64_t hits[2][4][4];
+	};
+
+	// Rule counts of the calling thread, only counted if macro FECTS_PROFILE_RULES is 1.
+	// Counting is cheap, but not free, so the macro is 0 by default. Reset with ruleProfile() = rule_profile_t();
+	inline rule_profile_t& ruleProfile()
+	{
+		thread_local rule_profile_t profile = {};
+		return profile;
+	}
+
+	namespace
+	{
+		// Find the start edge of the contour of seed pixel (x, y) like findContour does, see there for dir and clockwise.
+		// On return (x, y, dir) is the start edge, i.e. (x, y) may have moved one pixel forward.
+		inline void findStartEdge(int& x, int& y, int& dir, const bool clockwise, const uint8_t* const image, const int width, const int height, const int stride, const int label)
+		{
+			FECTS_Assert(0 <= x && x < width && 0 <= y && y < height, "seed pixel is outside of image");
+			FECTS_Assert(isForeground(x, y, image, width, height, stride, label), "seed pixel is not foreground");
+
+			if (dir == -1)
+			{
+				// find start edge; prefer edges of seed pixel (x,y)
+				/*
+				clockwise:
+				             ^           |           
+				           < |           |           
+				           < 4           |           
+				           < |           |           
+				             |    ^^^    |    ^^^    
+				  -----------+-----1---->+-----5---->
+				             ^           |           
+				           < |           | >         
+				           < 0           2 >         
+				           < |           | >         
+				             |           v           
+				  <----7-----+<----3-----+-----------
+				      vvv    |    vvv    |           
+				             |           | >         
+				             |           6 >         
+				             |           | >         
+				             |           v           
+
+				counterclockwise:
+				             |           ^           
+				             |           | >         
+				             |           4 >         
+				             |           | >         
+				      ^^^    |    ^^^    |           
+				  <----7-----+<----3-----+-----------
+				             |           ^           
+				           < |           | >         
+				           < 2           0 >         
+				           < |           | >         
+				             v           |           
+				  -----------+-----1---->+-----5---->
+				             |    vvv    |    vvv    
+				           < |           |           
+				           < 6           |           
+				           < |           |           
+				             v           |           
+				*/
+
+				for (dir = 0; dir < 4; dir++)
+				{
+					if (!isLeftForeground(x, y, dir, clockwise, image, width, height, stride, label))
+						break;
+				}
+
+				if (dir == 4)
+				{
+					for (dir = 0; dir < 4; dir++)
+					{
+						if (!isLeftForwardForeground(x, y, dir, clockwise, image, width, height, stride, label))
+							break;
+					}
+				}
+
+				FECTS_Assert(dir < 4, "bad seed pixel");
+			}
+
+			if (isLeftForeground(x, y, dir, clockwise, image, width, height, stride, label) &&
+				isForwardForeground(x, y, dir, clockwise, image, width, height, stride, label))
+			{
+				moveForward(x, y, dir);
+			}
+
+			FECTS_Assert(!isLeftForeground(x, y, dir, clockwise, image, width, height, stride, label), "bad seed direction");
+		}
+
+		// Trace loop of findContour: trace from edge (x, y, dir) until the start or stop edge is reached,
+		// until contour_length reaches max_contour_length if HasLengthLimit, or until stop_predicate returns a stop_reason.
+		// (x, y, dir), is_pixel_valid and contour_length are updated, so another call continues where this one stopped, see ContourTracer.
+		// The first edge is travelled without checking it against the start edge, and a single isolated pixel is left to the caller.
+		// Returns the sum of turns of this call.
+		template<bool Clockwise, bool SuppressBorder, bool HasStop, bool HasLengthLimit, bool LookupTable, typename TContour, typename TStopPredicate>
+		int traceContour(TContour& contour, const uint8_t* const image, const int width, const int height, const int stride, const int label, int& x, int& y, int& dir, bool& is_pixel_valid,
+			int& contour_length, const int max_contour_length, const int start_x, const int start_y, const int start_dir,
+			const int stop_x, const int stop_y, const int stop_dir, uint8_t* visited, TStopPredicate& stop_predicate, int& stop_reason)
+		{
+			// constants of this specialization, named like the arguments of the runtime version of findContour
+			const bool clockwise = Clockwise;
+			const bool do_suppress_border = SuppressBorder;
+			const bool has_length_limit = HasLengthLimit;
+			const bool is_stop_in = HasStop;
+			constexpr bool has_stop_predicate = !std::is_same<typename std::remove_const<TStopPredicate>::type, NoStopPredicate>::value;
+			constexpr bool has_edge_output = HasEdgeOutput<TContour>::value;
+
+			if (LookupTable)
+			{
+				return traceLookupTable<Clockwise, SuppressBorder, HasStop, HasLengthLimit, has_stop_predicate>(contour, image, width, height, stride, label, x, y, dir, is_pixel_valid,
+					contour_length, max_contour_length, start_x, start_y, start_dir, stop_x, stop_y, stop_dir, visited, stop_predicate, stop_reason);
+			}
+
+			int sum_of_turns = 0;
+
+			// rule counters indexed by clockwise * 16 + dir * 4 + rule, see ruleProfile
+			uint64_t* const rule_hits = FECTS_PROFILE_RULES ? &ruleProfile().hits[0][0][0] : NULL;
+
+#if !FECTS_GENERATOR_OPTIMIZED
+
+			/*
+			clockwise rules:
+			==================================
+			
+			    rule 1:              rule 2:              rule 3:              
+			    +-------+-------+    +-------+-------+    +-------+-------+    
+			    |       |       |    |       ^       |    |       |       |    1: foreground
+			    |   1   |  0/1  |    |   0   |   1   |    |   0   |   0   |    0: background or border
+			    |  ???  |       |    |       |  ???  |    |       |  ???  |    /: alternative
+			    +<------+-------+    +-------+-------+    +-------+------>+    
+			    |       ^       |    |       ^       |    |       ^       |    (x,y): current pixel
+			    |   0   |   1   |    |   0   |   1   |    |   0   |   1   |    ???: pixel to be checked
+			    |       | (x,y) |    |       | (x,y) |    |       | (x,y) |    
+			    +-------+-------+    +-------+-------+    +-------+-------+    
+			    - turn left          - move ahead         - turn right
+			    - emit pixel (x,y)   - emit pixel (x,y)
+
+			if forward-left pixel is foreground (rule 1)
+			    emit current pixel
+			    go to checked pixel
+			    turn left
+			    set pixel valid
+			    stop if buffer is full
+			    stop if stop predicate says so
+			else if forward pixel is foreground (rule 2)
+			    if pixel is valid
+			        emit current pixel
+			    go to checked pixel
+			    if border is to be suppressed, set pixel valid if left is not border
+			    stop if buffer is full
+			    stop if stop predicate says so
+			else (rule 3)
+			    turn right
+			    set pixel valid if left is not border
+
+			In case of counterclockwise tracing the rules are the same except that left and right are exchanged.
+			*/
+
+			do
+			{
+				if (visited != NULL)
+					visited[x + y * stride] |= uint8_t(1 << dir);
+				if (has_edge_output)
+					emplaceBackEdge(contour, x, y, dir, clockwise);
+
+				// (rule 1)
+				if (isLeftForwardConnected(x, y, dir, clockwise, image, width, height, stride, label))
+				{
+					if (FECTS_PROFILE_RULES)
+						++rule_hits[(clockwise ? 16 : 0) + dir * 4 + 1];
+					contour.emplace_back(x, y);
+					moveForward(x, y, dir);
+					moveLeft(x, y, dir, clockwise);
+					dir = turnLeft(dir, clockwise);
+					--sum_of_turns;
+					is_pixel_valid = true;
+					if (++contour_length >= max_contour_length && has_length_limit)
+						break;
+					if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						break;
+				}
+				// (rule 2)
+				else if (isForwardForeground(x, y, dir, clockwise, image, width, height, stride, label))
+				{
+					if (FECTS_PROFILE_RULES)
+						++rule_hits[(clockwise ? 16 : 0) + dir * 4 + 2];
+					if (!do_suppress_border || is_pixel_valid)
+					{
+						contour.emplace_back(x, y);
+					}
+					moveForward(x, y, dir);
+					if (do_suppress_border)
+						is_pixel_valid = !isLeftBorder(x, y, dir, clockwise, width, height);
+					if (++contour_length >= max_contour_length && has_length_limit) // contour_length is the unsuppressed length
+						break;
+					if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						break;
+				}
+				// (rule 3)
+				else
+				{
+					if (FECTS_PROFILE_RULES)
+						++rule_hits[(clockwise ? 16 : 0) + dir * 4 + 3];
+					dir = turnRight(dir, clockwise);
+					++sum_of_turns;
+					if (do_suppress_border && !is_pixel_valid)
+						is_pixel_valid = !isLeftBorder(x, y, dir, clockwise, width, height);
+				}
+			} while ((x != start_x || y != start_y || dir != start_dir)
+			         && (!is_stop_in || x != stop_x || y != stop_y || dir != stop_dir));
+
+#else
+
+			// pointer to current pixel
+			const uint8_t* pixel = &image[x + y * stride];
+
+			// constants to address 8-connected neighbours of pixel
+			constexpr int off_00 = 0;
+			constexpr int off_p0 = 1;
+			constexpr int off_m0 = -1;
+			const int off_0p = stride;
+			const int off_0m = -stride;
+			const int off_pp = off_p0 + off_0p;
+			const int off_pm = off_p0 + off_0m;
+			const int off_mp = off_m0 + off_0p;
+			const int off_mm = off_m0 + off_0m;
+
+			const int width_m1 = width - 1;
+			const int height_m1 = height - 1;
+
+			const int first_dir = dir;
+			int sum_of_turn_overflows = 0;
+
+			if (clockwise)
+			{
+				do
+				{
+					if (visited != NULL)
+						visited[pixel - image] |= uint8_t(1 << dir);
+					if (has_edge_output)
+						emplaceBackEdge(contour, x, y, dir, clockwise);
+
+					if (dir == 0)
+					{
+						/*
+						direction 0 basic clockwise rules:
+						==================================
+						
+						                     rule 1:              rule 2:              rule 3:              
+						                     +-------+-------+    +-------+-------+    +-------+-------+    
+						                     |       |       |    |       ^       |    |       |       |    1: foreground
+						                     |   1   |  0/1  |    |   0   |   1   |    |   0   |   0   |    0: background or border
+						                     |  ???  |       |    |       |  ???  |    |       |  ???  |    /: alternative
+						                     +<------+-------+    +-------+-------+    +-------+------>+    
+						                     |       ^       |    |       ^       |    |       ^       |    (x,y): current pixel
+						                     |   0   |   1   |    |   0   |   1   |    |   0   |   1   |    ???: pixel to be checked
+						                     |       | (x,y) |    |       | (x,y) |    |       | (x,y) |    
+						                     +-------+-------+    +-------+-------+    +-------+-------+    
+						                     - turn left          - move ahead         - turn right
+						                     - emit pixel (x,y)   - emit pixel (x,y)
+
+
+						direction 0 clockwise rules with border checks:
+						===============================================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       |       |    |       |       |    |       ^       |    |       |       |    1: foreground
+						|   b   |   b   |    |   1   |  0/1  |    |  0/b  |   1   |    |  0/b  |   0   |    0: background
+						|  ???  |  ???  |    |  ???  |       |    |       |  ???  |    |       |  ???  |    b: border outside of image
+						+-------+------>+    +<------+-------+    +-------+-------+    +-------+------>+    /: alternative
+						|       ^       |    |       ^       |    |       ^       |    |       ^       |
+						|  0/b  |   1   |    |   0   |   1   |    |  0/b  |   1   |    |  0/b  |   1   |    (x,y): current pixel
+						|       | (x,y) |    |       | (x,y) |    |       | (x,y) |    |       | (x,y) |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn right        => turn left         => move ahead        => turn right
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+
+						if forward is border (rule 0)
+						    turn right
+						else if left is not border and forward-left pixel is foreground (rule 1)
+						    emit current pixel
+						    go to checked pixel
+						    turn left
+						    set pixel valid
+						    stop if buffer is full
+						    stop if stop predicate says so for the pixel moved to
+						else if forward pixel is foreground (rule 2)
+						    if pixel is valid
+						        emit current pixel
+						    go to checked pixel
+						    if border is to be suppressed, set pixel valid if left is not border
+						    stop if buffer is full
+						    stop if stop predicate says so for the pixel moved to
+						else (rule 3)
+						    turn right
+						    set pixel valid if left is not border
+						*/
+
+						// if forward is border (rule 0)
+						if (y == 0)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[16];
+						    // turn right
+						    dir = 1;
+						}
+						// else if left is not border and forward-left pixel is foreground (rule 1)
+						else if (x != 0 && pixel[off_mm] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[17];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 3);
+						    // go to checked pixel
+						    pixel += off_mm;
+						    --x;
+						    --y;
+						    // turn left
+						    dir = 3;
+						    --sum_of_turn_overflows;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0m] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[18];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 2);
+						    }
+						    // go to checked pixel
+						    pixel += off_0m;
+						    --y;
+						    // if border is to be suppressed, set pixel valid if left is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = x != 0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit) // contour_length is the unsuppressed length
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[19];
+						    // turn right
+						    dir = 1;
+						    // set pixel valid if left is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = y != 0;
+						}
+					}
+					else if (dir == 1)
+					{
+						/*
+						direction 1 clockwise rules:
+						============================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       |       |    |       ^       |    |       |       |    |       |       |    1: foreground
+						|  0/b  |   b   |    |   0   |   1   |    |  0/b  |  0/b  |    |  0/b  |  0/b  |    0: background
+						|       |  ???  |    |       |  ???  |    |       |       |    |       |       |    b: border outside of image
+						+------>+-------+    +------>+-------+    +------>+------>+    +------>+-------+    /: alternative
+						|       |       |    |       |       |    |       |       |    |       |       |
+						|   1   |   b   |    |   1   |  0/1  |    |   1   |   1   |    |   1   |   0   |    (x,y): current pixel
+						| (x,y) v  ???  |    | (x,y) |       |    | (x,y) |  ???  |    | (x,y) v  ???  |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn right        => turn left         => move ahead        => turn right
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+						*/
+
+						// if forward is border (rule 0)
+						if (x == width_m1)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[20];
+						    // turn right
+						    dir = 2;
+						}
+						// else if left is not border and forward-left pixel is foreground (rule 1)
+						else if (y != 0 && pixel[off_pm] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[21];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 1);
+						    // go to checked pixel
+						    pixel += off_pm;
+						    ++x;
+						    --y;
+						    // turn left
+						    dir = 0;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_p0] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[22];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 0);
+						    }
+						    // go to checked pixel
+						    pixel += off_p0;
+						    ++x;
+						    // if border is to be suppressed, set pixel valid if left is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = y != 0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[23];
+						    // turn right
+						    dir = 2;
+						    // set pixel valid if left is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = x != width_m1;
+						}
+					}
+					else if (dir == 2)
+					{
+						/*
+						direction 2 clockwise rules:
+						============================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       |       |    |       |       |    |       |       |    |       |       |    1: foreground
+						|   1   |  0/b  |    |   1   |   0   |    |   1   |  0/b  |    |   1   |  0/b  |    0: background
+						| (x,y) v       |    | (x,y) v       |    | (x,y) v       |    | (x,y) v       |    b: border outside of image
+						+<------+-------+    +-------+------>+    +-------+-------+    +<------+-------+    /: alternative
+						|       |       |    |       |       |    |       |       |    |       |       |
+						|   b   |   b   |    |  0/1  |   1   |    |   1   |  0/b  |    |   0   |  0/b  |    (x,y): current pixel
+						|  ???  |  ???  |    |       |  ???  |    |  ???  v       |    |  ???  |       |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn right        => turn left         => move ahead        => turn right
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+						*/
+
+						// if forward is border (rule 0)
+						if (y == height_m1)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[24];
+						    // turn right
+						    dir = 3;
+						}
+						// else if left is not border and forward-left pixel is foreground (rule 1)
+						else if (x != width_m1 && pixel[off_pp] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[25];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 7);
+						    // go to checked pixel
+						    pixel += off_pp;
+						    ++x;
+						    ++y;
+						    // turn left
+						    dir = 1;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0p] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[26];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 6);
+						    }
+						    // go to checked pixel
+						    pixel += off_0p;
+						    ++y;
+						    // if border is to be suppressed, set pixel valid if left is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = x != width_m1;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[27];
+						    // turn right
+						    dir = 3;
+						    // set pixel valid if left is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = y != height_m1;
+						}
+					}
+					else
+					{
+						assert(dir == 3);
+						/*
+						direction 3 clockwise rules:
+						============================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       ^       |    |       |       |    |       |       |    |       ^       |    1: foreground
+						|   b   |   1   |    |  0/1  |   1   |    |   1   |   1   |    |   0   |   1   |    0: background
+						|  ???  | (x,y) |    |       | (x,y) |    |  ???  | (x,y) |    |  ???  | (x,y) |    b: border outside of image
+						+-------+<------+    +-------+<------+    +<------+<------+    +-------+<------+    /: alternative
+						|       |       |    |       |       |    |       |       |    |       |       |
+						|   b   |  0/b  |    |   1   |   0   |    |  0/b  |  0/b  |    |  0/b  |  0/b  |    (x,y): current pixel
+						|  ???  |       |    |  ???  v       |    |       |       |    |       |       |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn right        => turn left         => move ahead        => turn right
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+						*/
+
+						// if forward is border (rule 0)
+						if (x == 0)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[28];
+						    // turn right
+						    dir = 0;
+						    ++sum_of_turn_overflows;
+						}
+						// else if left is not border and forward-left pixel is foreground (rule 1)
+						else if (y != height_m1 && pixel[off_mp] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[29];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 5);
+						    // go to checked pixel
+						    pixel += off_mp;
+						    --x;
+						    ++y;
+						    // turn left
+						    dir = 2;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_m0] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[30];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 4);
+						    }
+						    // go to checked pixel
+						    pixel += off_m0;
+						    --x;
+						    // if border is to be suppressed, set pixel valid if left is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = y != height_m1;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[31];
+						    // turn right
+						    dir = 0;
+						    ++sum_of_turn_overflows;
+						    // set pixel valid if left is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = x != 0;
+						}
+					}
+				} while ((x != start_x || y != start_y || dir != start_dir)
+				         && (!is_stop_in || x != stop_x || y != stop_y || dir != stop_dir));
+			}
+			else
+			{
+				do
+				{
+					if (visited != NULL)
+						visited[pixel - image] |= uint8_t(1 << dir);
+					if (has_edge_output)
+						emplaceBackEdge(contour, x, y, dir, clockwise);
+
+					if (dir == 0)
+					{
+						/*
+						direction 0 counterclockwise rules:
+						===================================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       |       |    |       |       |    |       ^       |    |       |       |    1: foreground
+						|   b   |   b   |    |  0/1  |   1   |    |   1   |  0/b  |    |   0   |  0/b  |    0: background
+						|  ???  |  ???  |    |       |  ???  |    |  ???  |       |    |  ???  |       |    b: border outside of image
+						+<------+-------+    +-------+------>+    +-------+-------+    +<------+-------+    /: alternative
+						|       ^       |    |       ^       |    |       ^       |    |       ^       |
+						|   1   |  0/b  |    |   1   |   0   |    |   1   |  0/b  |    |   1   |  0/b  |    (x,y): current pixel
+						| (x,y) |       |    | (x,y) |       |    | (x,y) |       |    | (x,y) |       |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn left         => turn right        => move ahead        => turn left
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+
+						if forward is border (rule 0)
+						    turn left
+						else if right is not border and forward-right pixel is foreground (rule 1)
+						    emit current pixel
+						    go to checked pixel
+						    turn right
+						    set pixel valid
+						    stop if buffer is full
+						    stop if stop predicate says so for the pixel moved to
+						else if forward pixel is foreground (rule 2)
+						    if pixel is valid
+						        emit current pixel
+						    go to checked pixel
+						    if border is to be suppressed, set pixel valid if right is not border
+						    stop if buffer is full
+						    stop if stop predicate says so for the pixel moved to
+						else (rule 3)
+						    turn left
+						    set pixel valid if right is not border
+						*/
+
+						// if forward is border (rule 0)
+						if (y == 0)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[0];
+						    // turn left
+						    dir = 3;
+						    ++sum_of_turn_overflows;
+						}
+						// else if right is not border and forward-right pixel is foreground (rule 1)
+						else if (x != width_m1 && pixel[off_pm] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[1];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 1);
+						    // go to checked pixel
+						    pixel += off_pm;
+						    ++x;
+						    --y;
+						    // turn right
+						    dir = 1;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0m] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[2];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 2);
+						    }
+						    // go to checked pixel
+						    pixel += off_0m;
+						    --y;
+						    // if border is to be suppressed, set pixel valid if right is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = x != width_m1;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[3];
+						    // turn left
+						    dir = 3;
+						    ++sum_of_turn_overflows;
+						    // set pixel valid if right is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = y != 0;
+						}
+					}
+					else if (dir == 1)
+					{
+						/*
+						direction 1 counterclockwise rules:
+						===================================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       ^       |    |       |       |    |       |       |    |       ^       |    1: foreground
+						|   1   |   b   |    |   1   |  0/1  |    |   1   |   1   |    |   1   |   0   |    0: background
+						| (x,y) |  ???  |    | (x,y) |       |    | (x,y) |  ???  |    | (x,y) |  ???  |    b: border outside of image
+						+------>+-------+    +------>+-------+    +------>+------>+    +------>+-------+    /: alternative
+						|       |       |    |       |       |    |       |       |    |       |       |
+						|  0/b  |   b   |    |   0   |   1   |    |  0/b  |  0/b  |    |  0/b  |  0/b  |    (x,y): current pixel
+						|       |  ???  |    |       v  ???  |    |       |       |    |       |       |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn left         => turn right        => move ahead        => turn left
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+						*/
+
+						// if forward is border (rule 0)
+						if (x == width_m1)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[4];
+						    // turn left
+						    dir = 0;
+						}
+						// else if right is not border and forward-right pixel is foreground (rule 1)
+						else if (y != height_m1 && pixel[off_pp] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[5];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 7);
+						    // go to checked pixel
+						    pixel += off_pp;
+						    ++x;
+						    ++y;
+						    // turn right
+						    dir = 2;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_p0] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[6];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 0);
+						    }
+						    // go to checked pixel
+						    pixel += off_p0;
+						    ++x;
+						    // if border is to be suppressed, set pixel valid if right is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = y != height_m1;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[7];
+						    // turn left
+						    dir = 0;
+						    // set pixel valid if right is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = x != width_m1;
+						}
+					}
+					else if (dir == 2)
+					{
+						/*
+						direction 2 counterclockwise rules:
+						===================================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       |       |    |       |       |    |       |       |    |       |       |    1: foreground
+						|  0/b  |   1   |    |   0   |   1   |    |  0/b  |   1   |    |  0/b  |   1   |    0: background
+						|       v (x,y) |    |       v (x,y) |    |       v (x,y) |    |       v (x,y) |    b: border outside of image
+						+-------+------>+    +<------+-------+    +-------+-------+    +-------+------>+    /: alternative
+						|       |       |    |       |       |    |       |       |    |       |       |
+						|   b   |   b   |    |   1   |  0/1  |    |  0/b  |   1   |    |  0/b  |   0   |    (x,y): current pixel
+						|  ???  |  ???  |    |  ???  |       |    |       v  ???  |    |       |  ???  |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn left         => turn right        => move ahead        => turn left
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+						*/
+
+						// if forward is border (rule 0)
+						if (y == height_m1)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[8];
+						    // turn left
+						    dir = 1;
+						}
+						// else if right is not border and forward-right pixel is foreground (rule 1)
+						else if (x != 0 && pixel[off_mp] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[9];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 5);
+						    // go to checked pixel
+						    pixel += off_mp;
+						    --x;
+						    ++y;
+						    // turn right
+						    dir = 3;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0p] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[10];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 6);
+						    }
+						    // go to checked pixel
+						    pixel += off_0p;
+						    ++y;
+						    // if border is to be suppressed, set pixel valid if right is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = x != 0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[11];
+						    // turn left
+						    dir = 1;
+						    // set pixel valid if right is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = y != height_m1;
+						}
+					}
+					else
+					{
+						assert(dir == 3);
+						/*
+						direction 3 counterclockwise rules:
+						===================================
+
+						rule 0:              rule 1:              rule 2:              rule 3:
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						|       |       |    |       ^       |    |       |       |    |       |       |    1: foreground
+						|   b   |  0/b  |    |   1   |   0   |    |  0/b  |  0/b  |    |  0/b  |  0/b  |    0: background
+						|  ???  |       |    |  ???  |       |    |       |       |    |       |       |    b: border outside of image
+						+-------+<------+    +-------+<------+    +<------+<------+    +-------+<------+    /: alternative
+						|       |       |    |       |       |    |       |       |    |       |       |
+						|   b   |   1   |    |  0/1  |   1   |    |   1   |   1   |    |   0   |   1   |    (x,y): current pixel
+						|  ???  v (x,y) |    |       | (x,y) |    |  ???  | (x,y) |    |  ???  v (x,y) |    ???: pixel to be checked
+						+-------+-------+    +-------+-------+    +-------+-------+    +-------+-------+
+						=> turn left         => turn right        => move ahead        => turn left
+						                     => emit pixel (x,y)  => emit pixel (x,y)
+						*/
+
+						// if forward is border (rule 0)
+						if (x == 0)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[12];
+						    // turn left
+						    dir = 2;
+						}
+						// else if right is not border and forward-right pixel is foreground (rule 1)
+						else if (y != 0 && pixel[off_mm] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[13];
+						    // emit current pixel
+						    emplaceBackMove(contour, x, y, 3);
+						    // go to checked pixel
+						    pixel += off_mm;
+						    --x;
+						    --y;
+						    // turn right
+						    dir = 0;
+						    --sum_of_turn_overflows;
+						    // set pixel valid
+						    is_pixel_valid = true;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_m0] == label)
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[14];
+						    // if pixel is valid
+						    if (!do_suppress_border || is_pixel_valid)
+						    {
+						        // emit current pixel
+						        emplaceBackMove(contour, x, y, 4);
+						    }
+						    // go to checked pixel
+						    pixel += off_m0;
+						    --x;
+						    // if border is to be suppressed, set pixel valid if right is not border
+						    if (do_suppress_border)
+						        is_pixel_valid = y != 0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length && has_length_limit)
+						        break;
+						    // stop if stop predicate says so for the pixel moved to
+						    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    if (FECTS_PROFILE_RULES)
+						        ++rule_hits[15];
+						    // turn left
+						    dir = 2;
+						    // set pixel valid if right is not border
+						    if (do_suppress_border && !is_pixel_valid)
+						        is_pixel_valid = x != 0;
+						}
+					}
+				} while ((x != start_x || y != start_y || dir != start_dir)
+				         && (!is_stop_in || x != stop_x || y != stop_y || dir != stop_dir));
+			}
+
+			sum_of_turns = sum_of_turn_overflows * 4 + (clockwise ? dir - first_dir : first_dir - dir);
+
+#endif // FECTS_GENERATOR_OPTIMIZED
+
+			return sum_of_turns;
+		}
+	} // namespace
+
+	// @param contour Receives the resulting contour points. It should be initially empty if contour tracing starts new (but no check is done).
+	// TContour needs to implement a small sub-set of std::vector<cv::Point>:
+	//     void TContour::emplace_back(int x, int y)
+	// If TContour implements emplace_back_edge(int x, int y, int dir) too, it receives each contour edge, see ContourCrackCode.
+	//
+	// @param image Single channel 8 bit read access to the image to trace contour in.
+	// Pixel with value equal to label are foreground. All other pixels including those outside of image are background.
+	// TImage needs to implement a small sub-set of cv::Mat and expects continuous row-major single 8 bit channel raster image memory:
+	//     int TImage::rows; // number of rows, i.e. image height
+	//     int TImage::cols; // number of columns, i.e. image width
+	//     uint8_t* TImage::ptr(int row, int column) // get pointer to pixel in image at row y and column x; row/column counting starts at zero
+	// 
+	// @param label Pixel values equal to this value are considered to be foreground, e.g. the id of a connected component.
+	// 
+	// @param x Seed pixel x coordinate.
+	// @param y Seed pixel y coordinate.
+	// Usually seed pixel (x,y) is taken as the start pixel, but if (x,y) touches the contour only by a corner
+	// (but not by an edge), the start pixel is moved one pixel forward in the given (or automatically chosen) direction
+	// to ensure the resulting contour is consistently 8-connected thin.
+	// The start pixel will be the first pixel in contour, unless it has only contour edges at the image border and do_suppress_border is set.
+	//
+	// @param dir Direction to start contour tracing with. 0 is up, 1 is right, 2 is down, 3 is left.
+	// If value is -1, no direction dir is given and a direction is chosen automatically.
+	// This works well if the seed pixel is part of a single contour only.
+	// If the object to trace is very narrow and the seed pixel is touching the contour on both sides,
+	// the side with the smallest dir is chosen.
+	// Note that a seed pixel can be part of up to four different contours, but no more than one of them can be an outer contour.
+	// So if you expect an outer contour and an outer contour is found, you are good.
+	// Otherwise you need to be more specific.
+	//
+	// @param clockwise Indicates if outer contours are traced clockwise or counterclockwise.
+	// Note that inner contours run in the opposite direction.
+	// If tracing is clockwise, the traced edge is to the left of the current pixel (looking in the current direction),
+	// otherwise the traced edge is to the right.
+	// Set it to false to trace similar to OpenCV cv::findContours.
+	//
+	// @param do_suppress_border Indicates to omit pixels of the contour that are followed on border edges only.
+	// The contour still contains border pixels where it arrives at the image border or where it leaves tha image border,
+	// but not those pixel that only follow the border.
+	//
+	// @param stop Structure to control stop behavior and to return extra information on the state of tracing at the end.
+	//
+	// @param visited Optional side buffer with 1 byte per pixel, using the same stride as image (counted in pixels).
+	// For each oriented contour edge (x, y, dir) travelled bit dir of the pixel at (x, y) is set. Bits 4 to 7 are not changed.
+	// Use the same value of clockwise for all traces that share a buffer, since it determines on which side of the pixel the edge is.
+	//
+	// @param stop_predicate Optional stop predicate, e.g. StopAtBoundingBox, to stop tracing early at a pixel it rejects.
+	// Its reason to stop is returned in stop.reason. It is passed by reference, so its state can be read after tracing.
+	//
+	// @return The total difference between left and right turns done during tracing.
+	// If a contour is traced completely, i.e. it is traced until it returns to the start edge,
+	// the value is 4 for an outer contour and -4 if it is an inner contour.
+	// When tracing stops due to stop.max_contour_length the contour is usually not traced completely.
+	// Even if all pixels have been found, up to 3 final edge tracing turns may not have been done,
+	// so if you somehow know that all pixels have been found, you can still use the sign of the return value
+	// to decide if it is an outer or inner contour.
+	template<typename TContour, typename TImage, typename TStopPredicate = NoStopPredicate>
+	int findContour(TContour& contour, TImage const& image, const int label, int x, int y, int dir = -1, bool clockwise = false, bool do_suppress_border = false, stop_t* stop = NULL, uint8_t* visited = NULL, TStopPredicate&& stop_predicate = TStopPredicate())
+	{
+		FECTS_Assert(-1 <= dir && dir < 4, "seed direction is invalid");
+
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		return findContour(contour, image_ptr, width, height, stride, label, x, y, dir, clockwise, do_suppress_border, stop, visited, stop_predicate);
+	}
+
+
+	// Like findContour above, but with a C-style image.
+	// @param image Pointer to image memory, 1 byte per pixel, row-major.
+	// @param width Width of image, i.e. image dimension in x coordinate.
+	// @param height Height of image, i.e. image dimension in y coordinate.
+	// @param stride Stride of image, i.e. offset between start of consecutive rows, i.e. width plus padding at the end of the image line, counted in pixels.
+	// @param label Label of the region to trace.
+	// Pixel with value equal to label are foreground. All other pixels including those outside of image are background.
+	// 
+	// @param x Seed pixel x coordinate.
+	// @param y Seed pixel y coordinate.
+	// Usually seed pixel (x,y) is taken as the start pixel, but if (x,y) touches the contour only by a corner
+	// (but not by an edge), the start pixel is moved one pixel forward in the given (or automatically chosen) direction
+	// to ensure the resulting contour is consistently 8-connected thin.
+	// The start pixel will be the first pixel in contour, unless it has only contour edges at the image border and do_suppress_border is set.
+	//
+	// @param dir Direction to start contour tracing with. 0 is up, 1 is right, 2 is down, 3 is left.
+	// If value is -1, no direction dir is given and a direction is chosen automatically.
+	// This works well if the seed pixel is part of a single contour only.
+	// If the object to trace is very narrow and the seed pixel is touching the contour on both sides,
+	// the side with the smallest dir is chosen.
+	// Note that a seed pixel can be part of up to four different contours, but no more than one of them can be an outer contour.
+	// So if you expect an outer contour and an outer contour is found, you are good.
+	// Otherwise you need to be more specific.
+	//
+	// @param clockwise Indicates if outer contours are traced clockwise or counterclockwise.
+	// Note that inner contours run in the opposite direction.
+	// If tracing is clockwise, the traced edge is to the left of the current pixel (looking in the current direction),
+	// otherwise the traced edge is to the right.
+	// Set it to false to trace similar to OpenCV cv::findContours.
+	//
+	// @param do_suppress_border Indicates to omit pixels of the contour that are followed on border edges only.
+	// The contour still contains border pixels where it arrives at the image border or where it leaves tha image border,
+	// but not those pixel that only follow the border.
+	//
+	// @param stop Structure to control stop behavior and to return extra information on the state of tracing at the end.
+	//
+	// @param visited Optional side buffer with 1 byte per pixel, using the same stride as image (counted in pixels).
+	// For each oriented contour edge (x, y, dir) travelled bit dir of the pixel at (x, y) is set. Bits 4 to 7 are not changed.
+	// Use the same value of clockwise for all traces that share a buffer, since it determines on which side of the pixel the edge is.
+	//
+	// @param stop_predicate Optional stop predicate, e.g. StopAtBoundingBox, to stop tracing early at a pixel it rejects.
+	// Its reason to stop is returned in stop.reason. It is passed by reference, so its state can be read after tracing.
+	//
+	// @return The total difference between left and right turns done during tracing.
+	// If a contour is traced completely, i.e. it is traced until it returns to the start edge,
+	// the value is 4 for an outer contour and -4 if it is an inner contour.
+	// When tracing stops due to stop.max_contour_length the contour is usually not traced completely.
+	// Even if all pixels have been found, up to 3 final edge tracing turns may not have been done,
+	// so if you somehow know that all pixels have been found, you can still use the sign of the return value
+	// to decide if it is an outer or inner contour.
+	template<typename TContour, typename TStopPredicate = NoStopPredicate>
+	int findContour(TContour& contour, const uint8_t* const image, const int width, const int height, const int stride, const int label, int x, int y, int dir = -1, bool clockwise = false, bool do_suppress_border = false, stop_t* stop = NULL, uint8_t* visited = NULL, TStopPredicate&& stop_predicate = TStopPredicate())
+	{
+		const bool has_stop = stop != NULL && stop->dir >= 0 && stop->dir < 4;
+		const bool has_length_limit = stop != NULL && stop->max_contour_length >= 0;
+		switch ((clockwise ? 8 : 0) | (do_suppress_border ? 4 : 0) | (has_stop ? 2 : 0) | (has_length_limit ? 1 : 0))
+		{
+		case 0: return findContour<false, false, false, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 1: return findContour<false, false, false, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 2: return findContour<false, false, true, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 3: return findContour<false, false, true, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 4: return findContour<false, true, false, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 5: return findContour<false, true, false, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 6: return findContour<false, true, true, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 7: return findContour<false, true, true, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 8: return findContour<true, false, false, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 9: return findContour<true, false, false, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 10: return findContour<true, false, true, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 11: return findContour<true, false, true, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 12: return findContour<true, true, false, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 13: return findContour<true, true, false, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		case 14: return findContour<true, true, true, false>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		default: return findContour<true, true, true, true>(contour, image, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+		}
+	}
+
+	// Like findContour above, but the arguments clockwise and do_suppress_border and the kind of stop are template parameters.
+	// So each combination gets its own trace loop with all branches on them removed at compile time.
+	// HasStop indicates that stop->dir is a valid direction, i.e. that there is a stop position.
+	// HasLengthLimit indicates that stop->max_contour_length >= 0.
+	// Without length limit the loop does not check the contour length at all, since tracing always returns to the start edge.
+	// Mismatch of stop and HasStop or HasLengthLimit is an error.
+	// LookupTable selects the lookup table engine instead of the rule code, see traceLookupTable.
+	// Its default is set by macro FECTS_LOOKUP_TABLE_ENGINE, which also selects the engine of the runtime version.
+	template<bool Clockwise, bool SuppressBorder, bool HasStop, bool HasLengthLimit, bool LookupTable = FECTS_LOOKUP_TABLE_ENGINE != 0, typename TContour, typename TStopPredicate = NoStopPredicate>
+	int findContour(TContour& contour, const uint8_t* const image, const int width, const int height, const int stride, const int label, int x, int y, int dir = -1, stop_t* stop = NULL, uint8_t* visited = NULL, TStopPredicate&& stop_predicate = TStopPredicate())
+	{
+		// constants of this specialization, named like the arguments of the runtime version
+		const bool clockwise = Clockwise;
+		const bool do_suppress_border = SuppressBorder;
+		FECTS_Assert(HasStop == (stop != NULL && stop->dir >= 0 && stop->dir < 4), "stop position does not match HasStop");
+		FECTS_Assert(HasLengthLimit == (stop != NULL && stop->max_contour_length >= 0), "stop length does not match HasLengthLimit");
+
+		findStartEdge(x, y, dir, clockwise, image, width, height, stride, label);
+
+		const int start_x = x;
+		const int start_y = y;
+		const int start_dir = dir;
+
+		const bool is_stop_in = HasStop;
+		if (is_stop_in)
+		{
+			FECTS_Assert(isForeground(stop->x, stop->y, image, width, height, stride, label), "stop pixel is not foreground");
+			FECTS_Assert(!isLeftForeground(stop->x, stop->y, stop->dir, clockwise, image, width, height, stride, label), "stop pixel has bad direction");
+		}
+		const int stop_x = is_stop_in ? stop->x : start_x;
+		const int stop_y = is_stop_in ? stop->y : start_y;
+		const int stop_dir = is_stop_in ? stop->dir : start_dir;
+
+		const int max_contour_length = stop != NULL && stop->max_contour_length >= 0
+			? std::min(stop->max_contour_length, upperLimitContourLength(width, height))
+			: upperLimitContourLength(width, height);
+		int contour_length = 0;
+		int sum_of_turns = 0;
+
+		// If do_suppress_border=true is_pixel_valid indicates if the current pixel has an edge
+		// on contour which is inside of the image, i.e. not only edges at image border.
+		// Otherwise it is always true.
+		bool is_pixel_valid = !do_suppress_border ||
+			hasPixelNonBorderEdgeBackwards(x, y, dir, clockwise, image, width, height, stride, label);
+
+		// the start pixel is checked before tracing, all other pixels when tracing moves to them
+		int stop_reason = stop_predicate(x, y);
+
+		if (max_contour_length > 0 && stop_reason == 0)
+		{
+			sum_of_turns = traceContour<Clockwise, SuppressBorder, HasStop, HasLengthLimit, LookupTable>(contour, image, width, height, stride, label, x, y, dir, is_pixel_valid,
+				contour_length, max_contour_length, start_x, start_y, start_dir, stop_x, stop_y, stop_dir, visited, stop_predicate, stop_reason);
+
+			if (contour_length == 0 && stop_reason == 0)
+			{
+				// contour object is a single isolated pixel
+				if (is_pixel_valid)
+				{
+					contour.emplace_back(start_x, start_y);
+				}
+				++contour_length; // contour_length is the unsuppressed length
+			}
+		}
+
+		if (stop != NULL)
+		{
+			stop->max_contour_length = contour_length; // unsuppressed contour length
+			stop->x = x;
+			stop->y = y;
+			stop->dir = dir;
+
+			if (stop_reason == 0)
+			{
+				if (HasStop && x == stop_x && y == stop_y && dir == stop_dir)
+					stop_reason = STOP_AT_POSITION;
+				else if (x != start_x || y != start_y || dir != start_dir || max_contour_length == 0)
+					stop_reason = STOP_AT_LENGTH;
+			}
+			stop->reason = stop_reason;
+		}
+
+		return sum_of_turns;
+	}
+
+	// Like the compile-time specialized findContour above, but with an image as in findContour.
+	template<bool Clockwise, bool SuppressBorder, bool HasStop, bool HasLengthLimit, bool LookupTable = FECTS_LOOKUP_TABLE_ENGINE != 0, typename TContour, typename TImage, typename TStopPredicate = NoStopPredicate>
+	int findContour(TContour& contour, TImage const& image, const int label, int x, int y, int dir = -1, stop_t* stop = NULL, uint8_t* visited = NULL, TStopPredicate&& stop_predicate = TStopPredicate())
+	{
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		return findContour<Clockwise, SuppressBorder, HasStop, HasLengthLimit, LookupTable>(contour, image_ptr, width, height, stride, label, x, y, dir, stop, visited, stop_predicate);
+	}
+
+	// Trace a contour in steps of a limited number of pixels, e.g. to interleave the tracing of many contours
+	// within a time budget per frame. The constructor does the startup logic of findContour,
+	// i.e. choosing the start edge and, with do_suppress_border, checking the start pixel backwards.
+	// Each call of trace continues the trace loop where the previous call stopped, keeping all of its state,
+	// so the points of all steps together are the contour found by findContour with the same arguments,
+	// and sumOfTurns finally is its return value. The image and visited must be kept until tracing is done.
+	//
+	// Example, with the arguments of findContour except contour and stop:
+	//     FECTS_L::ContourTracer tracer(image, ..., x, y);
+	//     while (!tracer.trace(contour, 1000))
+	//         doOtherWork();
+	class ContourTracer
+	{
+		// image and arguments of findContour
+		const uint8_t* image;
+		int width;
+		int height;
+		int stride;
+		int label;
+		bool clockwise;
+		bool do_suppress_border;
+		uint8_t* visited;
+
+		// state of the trace loop
+		int x = 0, y = 0, dir = 0;
+		int start_x = 0, start_y = 0, start_dir = 0;
+		bool is_pixel_valid = true;
+		int contour_length = 0; // unsuppressed length
+		int sum_of_turns = 0;
+		bool is_done = false;
+
+		void start(int seed_x, int seed_y, int seed_dir)
+		{
+			FECTS_Assert(-1 <= seed_dir && seed_dir < 4, "seed direction is invalid");
+
+			x = seed_x;
+			y = seed_y;
+			dir = seed_dir;
+			findStartEdge(x, y, dir, clockwise, image, width, height, stride, label);
+
+			start_x = x;
+			start_y = y;
+			start_dir = dir;
+
+			is_pixel_valid = !do_suppress_border ||
+				hasPixelNonBorderEdgeBackwards(x, y, dir, clockwise, image, width, height, stride, label);
+		}
+
+		template<bool Clockwise, bool SuppressBorder, typename TContour>
+		int traceSteps(TContour& contour, int max_contour_length)
+		{
+			NoStopPredicate no_stop_predicate;
+			int stop_reason = 0;
+			return traceContour<Clockwise, SuppressBorder, false, true, FECTS_LOOKUP_TABLE_ENGINE != 0>(contour, image, width, height, stride, label, x, y, dir, is_pixel_valid,
+				contour_length, max_contour_length, start_x, start_y, start_dir, start_x, start_y, start_dir, visited, no_stop_predicate, stop_reason);
+		}
+
+	public:
+		// See findContour for description of parameters.
+		ContourTracer(const uint8_t* image, int width, int height, int stride, const int label, int x, int y, int dir = -1, bool clockwise = false, bool do_suppress_border = false, uint8_t* visited = NULL) :
+			image(image),
+			width(width),
+			height(height),
+			stride(stride),
+			label(label),
+			clockwise(clockwise),
+			do_suppress_border(do_suppress_border),
+			visited(visited)
+		{
+			start(x, y, dir);
+		}
+
+		// Like the constructor above, but with an image as in findContour.
+		template<typename TImage>
+		ContourTracer(TImage const& image, const int label, int x, int y, int dir = -1, bool clockwise = false, bool do_suppress_border = false, uint8_t* visited = NULL) :
+			width(image.cols),
+			height(image.rows),
+			label(label),
+			clockwise(clockwise),
+			do_suppress_border(do_suppress_border),
+			visited(visited)
+		{
+			FECTS_Assert(width > 0 && height > 0, "image is empty");
+			this->image = imagePointer(stride, image);
+			start(x, y, dir);
+		}
+
+		// Continue tracing until count more contour pixels are traced or the contour is complete.
+		// Like stop_t::max_contour_length, count includes suppressed pixels, so fewer points may be emitted.
+		// @param contour Receives the contour points of this step after those of previous steps, see findContour.
+		// @param count Maximum number of contour pixels to trace in this step, must be positive.
+		// @return True if the contour is complete, i.e. tracing is done and further calls do nothing.
+		template<typename TContour>
+		bool trace(TContour& contour, int count)
+		{
+			FECTS_Assert(count > 0, "count is not positive");
+			if (is_done)
+				return true;
+
+			const int max_contour_length = contour_length + std::min(count, upperLimitContourLength(width, height));
+			switch ((clockwise ? 2 : 0) | (do_suppress_border ? 1 : 0))
+			{
+			case 0: sum_of_turns += traceSteps<false, false>(contour, max_contour_length); break;
+			case 1: sum_of_turns += traceSteps<false, true>(contour, max_contour_length); break;
+			case 2: sum_of_turns += traceSteps<true, false>(contour, max_contour_length); break;
+			default: sum_of_turns += traceSteps<true, true>(contour, max_contour_length); break;
+			}
+
+			is_done = x == start_x && y == start_y && dir == start_dir;
+			if (is_done && contour_length == 0)
+			{
+				// contour object is a single isolated pixel
+				if (is_pixel_valid)
+				{
+					contour.emplace_back(start_x, start_y);
+				}
+				++contour_length; // contour_length is the unsuppressed length
+			}
+
+			return is_done;
+		}
+
+		// Indicates if the contour is complete.
+		bool isDone() const { return is_done; }
+
+		// Sum of turns so far, see return value of findContour.
+		int sumOfTurns() const { return sum_of_turns; }
+
+		// Number of contour pixels traced so far including suppressed pixels, see stop_t::max_contour_length.
+		int contourLength() const { return contour_length; }
+
+		// Edge (x, y, dir) where tracing continues, as returned by findContour in stop.
+		stop_t position() const
+		{
+			stop_t edge;
+			edge.max_contour_length = contour_length;
+			edge.x = x;
+			edge.y = y;
+			edge.dir = dir;
+			return edge;
+		}
+	};
+
+	// Trace the part of a contour around a seed pixel, with up to count pixels before and after the start pixel,
+	// e.g. for local shape analysis around a detected point.
+	// The contour is traced forward from the start edge like findContour does, and backward from the same edge
+	// by turning around and tracing with the opposite orientation, like hasPixelNonBorderEdgeBackwards does.
+	// Each half stops after count pixels, so the time does not depend on the length of the contour.
+	// If the contour has no more than 2 * count + 1 pixels, the fragment is the whole contour, rotated to center the start pixel.
+	//
+	// @param contour Receives the fragment in the order of forward tracing. It should be initially empty (but no check is done).
+	// TContour needs to implement a small sub-set of std::vector<cv::Point>:
+	//     void TContour::emplace_back(int x, int y)
+	//
+	// @param image, width, height, stride As in findContour.
+	// @param label Label of the region to trace.
+	// @param x, y, dir, clockwise Seed pixel, its direction and orientation of tracing as in findContour. Border suppression is not supported.
+	// @param count Maximum number of pixels before and after the start pixel.
+	//
+	// @return Index of the start pixel in contour, count unless the whole contour has less than 2 * count + 1 pixels.
+	template<typename TContour>
+	int findContourFragment(TContour& contour, const uint8_t* const image, const int width, const int height, const int stride, const int label, int x, int y, int count, int dir = -1, bool clockwise = false)
+	{
+		FECTS_Assert(count >= 0, "count is negative");
+
+		findStartEdge(x, y, dir, clockwise, image, width, height, stride, label);
+
+		// start pixel and up to count pixels after it
+		std::vector<int> forward;
+		FlatContour forward_contour{ forward };
+		stop_t forward_stop;
+		forward_stop.max_contour_length = count + 1;
+		findContour(forward_contour, image, width, height, stride, label, x, y, dir, clockwise, false, &forward_stop);
+
+		// start pixel and up to count pixels before it, in backward order;
+		// a short contour is traced completely when the backward half reaches the edge where the forward half stopped
+		std::vector<int> backward;
+		bool is_whole_contour = forward_stop.reason == STOP_CLOSED;
+		if (!is_whole_contour && forward_stop.x == x && forward_stop.y == y)
+		{
+			// the forward half may have stopped on the start pixel with only rule 3 turns left to the start edge
+			int turn_dir = forward_stop.dir;
+			while (turn_dir != dir && !isLeftForwardConnected(x, y, turn_dir, clockwise, image, width, height, stride, label) &&
+				!isForwardForeground(x, y, turn_dir, clockwise, image, width, height, stride, label))
+			{
+				turn_dir = turnRight(turn_dir, clockwise);
+			}
+			is_whole_contour = turn_dir == dir;
+		}
+		if (!is_whole_contour)
+		{
+			FlatContour backward_contour{ backward };
+			stop_t backward_stop;
+			backward_stop.max_contour_length = count + 1;
+			backward_stop.x = forward_stop.x;
+			backward_stop.y = forward_stop.y;
+			backward_stop.dir = (forward_stop.dir + 2) % 4;
+			findContour(backward_contour, image, width, height, stride, label, x, y, (dir + 2) % 4, !clockwise, false, &backward_stop);
+
+			if (backward_stop.reason == STOP_AT_POSITION)
+			{
+				// the halves meet on the pixel where both stopped, so append it and the backward half to get the whole contour
+				forward.push_back(forward_stop.x);
+				forward.push_back(forward_stop.y);
+				for (size_t i = backward.size() - 2; i >= 2; i -= 2)
+				{
+					forward.push_back(backward[i]);
+					forward.push_back(backward[i + 1]);
+				}
+				is_whole_contour = true;
+			}
+		}
+
+		if (is_whole_contour)
+		{
+			// rotate the whole contour, so the start pixel is in the center
+			const int length = int(forward.size() / 2);
+			const int fragment_length = std::min(length, 2 * count + 1);
+			const int before = fragment_length / 2;
+			for (int i = length - before; i < length; i++)
+				contour.emplace_back(forward[2 * i], forward[2 * i + 1]);
+			for (int i = 0; i < fragment_length - before; i++)
+				contour.emplace_back(forward[2 * i], forward[2 * i + 1]);
+			return before;
+		}
+
+		// backward half in forward order without the start pixel, then the forward half
+		const int before = int(backward.size() / 2) - 1;
+		for (int i = before; i > 0; i--)
+			contour.emplace_back(backward[2 * i], backward[2 * i + 1]);
+		for (size_t i = 0; i < forward.size(); i += 2)
+			contour.emplace_back(forward[i], forward[i + 1]);
+		return before;
+	}
+
+	// Like findContourFragment above, but with an image as in findContour.
+	template<typename TContour, typename TImage>
+	int findContourFragment(TContour& contour, TImage const& image, const int label, int x, int y, int count, int dir = -1, bool clockwise = false)
+	{
+		FECTS_Assert(-1 <= dir && dir < 4, "seed direction is invalid");
+
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		return findContourFragment(contour, image_ptr, width, height, stride, label, x, y, count, dir, clockwise);
+	}
+
+	// Like findContour, but the image needs a frame of background pixels, i.e. all pixels of the first and last row
+	// and of the first and last column are background. So all neighbours of a contour pixel are inside of the image,
+	// and the trace loop does not need any border checks. It only moves the pixel pointer,
+	// and x and y are computed from it when a pixel is emitted. The contour never touches the border,
+	// so there is no parameter do_suppress_border. The frame is checked by assert in debug builds only.
+	// The start edge is chosen by findContour, so the result is the same as with findContour.
+	// There is no stop predicate, so stop.reason is STOP_CLOSED, STOP_AT_POSITION or STOP_AT_LENGTH.
+	// If you have no frame, you can copy the image to a buffer that is 2 pixels larger in width and height,
+	// e.g. by cv::copyMakeBorder, and subtract 1 from the resulting coordinates.
+	//
+	// See findContour for description of parameters and return value.
+	template<typename TContour>
+	int findContourFramed(TContour& contour, const uint8_t* const image, const int width, const int height, const int stride, const int label, int x, int y, int dir = -1, bool clockwise = false, stop_t* stop = NULL, uint8_t* visited = NULL)
+	{
+		FECTS_Assert(width >= 3 && height >= 3, "image is too small to have a frame");
+#ifndef NDEBUG
+		for (int i = 0; i < width; i++)
+			assert(!isForeground(i, 0, image, width, height, stride, label) && !isForeground(i, height - 1, image, width, height, stride, label));
+		for (int i = 0; i < height; i++)
+			assert(!isForeground(0, i, image, width, height, stride, label) && !isForeground(width - 1, i, image, width, height, stride, label));
+#endif
+
+#if !FECTS_GENERATOR_OPTIMIZED
+
+		return findContour(contour, image, width, height, stride, label, x, y, dir, clockwise, false, stop, visited);
+
+#else
+
+		// the trace loop below does not track x and y, so contours which take the edges are traced by findContour
+		if (HasEdgeOutput<TContour>::value)
+			return findContour(contour, image, width, height, stride, label, x, y, dir, clockwise, false, stop, visited);
+
+		// find start edge like findContour does
+		stop_t start;
+		start.max_contour_length = 0;
+		NoContour no_contour;
+		findContour(no_contour, image, width, height, stride, label, x, y, dir, clockwise, false, &start);
+		const int start_dir = start.dir;
+
+		const bool is_stop_in = stop != NULL && 0 <= stop->dir && stop->dir < 4;
+		if (is_stop_in)
+		{
+			FECTS_Assert(isForeground(stop->x, stop->y, image, width, height, stride, label), "stop pixel is not foreground");
+			FECTS_Assert(!isLeftForeground(stop->x, stop->y, stop->dir, clockwise, image, width, height, stride, label), "stop pixel has bad direction");
+		}
+		const int stop_dir = is_stop_in ? stop->dir : start_dir;
+
+		const int max_contour_length = stop != NULL && stop->max_contour_length >= 0
+			? std::min(stop->max_contour_length, upperLimitContourLength(width, height))
+			: upperLimitContourLength(width, height);
+		int contour_length = 0;
+		int sum_of_turn_overflows = 0;
+		dir = start_dir;
+
+		// pointer to current pixel
+		const uint8_t* pixel = &image[start.x + start.y * stride];
+		const uint8_t* const start_pixel = pixel;
+		const uint8_t* const stop_pixel = is_stop_in ? &image[stop->x + stop->y * stride] : start_pixel;
+
+		// constants to address 8-connected neighbours of pixel
+		constexpr int off_p0 = 1;
+		constexpr int off_m0 = -1;
+		const int off_0p = stride;
+		const int off_0m = -stride;
+		const int off_pp = off_p0 + off_0p;
+		const int off_pm = off_p0 + off_0m;
+		const int off_mp = off_m0 + off_0p;
+		const int off_mm = off_m0 + off_0m;
+
+		if (max_contour_length > 0)
+		{
+			if (clockwise)
+			{
+				do
+				{
+					if (visited != NULL)
+						visited[pixel - image] |= uint8_t(1 << dir);
+
+					if (dir == 0)
+					{
+						// if forward-left pixel is foreground (rule 1)
+						if (pixel[off_mm] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_mm;
+						    // turn left
+						    dir = 3;
+						    --sum_of_turn_overflows;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0m] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_0m;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn right
+						    dir = 1;
+						}
+					}
+					else if (dir == 1)
+					{
+						// if forward-left pixel is foreground (rule 1)
+						if (pixel[off_pm] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_pm;
+						    // turn left
+						    dir = 0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_p0] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_p0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn right
+						    dir = 2;
+						}
+					}
+					else if (dir == 2)
+					{
+						// if forward-left pixel is foreground (rule 1)
+						if (pixel[off_pp] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_pp;
+						    // turn left
+						    dir = 1;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0p] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_0p;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn right
+						    dir = 3;
+						}
+					}
+					else
+					{
+						assert(dir == 3);
+						// if forward-left pixel is foreground (rule 1)
+						if (pixel[off_mp] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_mp;
+						    // turn left
+						    dir = 2;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_m0] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_m0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn right
+						    dir = 0;
+						    ++sum_of_turn_overflows;
+						}
+					}
+				} while ((pixel != start_pixel || dir != start_dir)
+				         && (!is_stop_in || pixel != stop_pixel || dir != stop_dir));
+			}
+			else
+			{
+				do
+				{
+					if (visited != NULL)
+						visited[pixel - image] |= uint8_t(1 << dir);
+
+					if (dir == 0)
+					{
+						// if forward-right pixel is foreground (rule 1)
+						if (pixel[off_pm] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_pm;
+						    // turn right
+						    dir = 1;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0m] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_0m;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn left
+						    dir = 3;
+						    ++sum_of_turn_overflows;
+						}
+					}
+					else if (dir == 1)
+					{
+						// if forward-right pixel is foreground (rule 1)
+						if (pixel[off_pp] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_pp;
+						    // turn right
+						    dir = 2;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_p0] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_p0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn left
+						    dir = 0;
+						}
+					}
+					else if (dir == 2)
+					{
+						// if forward-right pixel is foreground (rule 1)
+						if (pixel[off_mp] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_mp;
+						    // turn right
+						    dir = 3;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_0p] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_0p;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn left
+						    dir = 1;
+						}
+					}
+					else
+					{
+						assert(dir == 3);
+						// if forward-right pixel is foreground (rule 1)
+						if (pixel[off_mm] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_mm;
+						    // turn right
+						    dir = 0;
+						    --sum_of_turn_overflows;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else if forward pixel is foreground (rule 2)
+						else if (pixel[off_m0] == label)
+						{
+						    // emit current pixel
+						    emplaceBackIndex(contour, pixel - image, stride);
+						    // go to checked pixel
+						    pixel += off_m0;
+						    // stop if buffer is full
+						    if (++contour_length >= max_contour_length)
+						        break;
+						}
+						// else (rule 3)
+						else
+						{
+						    // turn left
+						    dir = 2;
+						}
+					}
+				} while ((pixel != start_pixel || dir != start_dir)
+				         && (!is_stop_in || pixel != stop_pixel || dir != stop_dir));
+			}
+
+			if (contour_length == 0)
+			{
+				// contour object is a single isolated pixel
+				contour.emplace_back(start.x, start.y);
+				++contour_length;
+			}
+		}
+
+		if (stop != NULL)
+		{
+			const unsigned index = unsigned(pixel - image);
+			stop->max_contour_length = contour_length;
+			stop->y = int(index / unsigned(stride));
+			stop->x = int(index - unsigned(stop->y) * unsigned(stride));
+			stop->dir = dir;
+
+			if (is_stop_in && pixel == stop_pixel && dir == stop_dir)
+				stop->reason = STOP_AT_POSITION;
+			else if (pixel != start_pixel || dir != start_dir || max_contour_length == 0)
+				stop->reason = STOP_AT_LENGTH;
+			else
+				stop->reason = STOP_CLOSED;
+		}
+
+		return sum_of_turn_overflows * 4 + (clockwise ? dir - start_dir : start_dir - dir);
+
+#endif // FECTS_GENERATOR_OPTIMIZED
+	}
+
+	// Like findContourFramed above, but with an image as in findContour.
+	template<typename TContour, typename TImage>
+	int findContourFramed(TContour& contour, TImage const& image, const int label, int x, int y, int dir = -1, bool clockwise = false, stop_t* stop = NULL, uint8_t* visited = NULL)
+	{
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		return findContourFramed(contour, image_ptr, width, height, stride, label, x, y, dir, clockwise, stop, visited);
+	}
+
+	// Find the next run of foreground pixels in row y, starting the search at pixel x.
+	// The pixels at the ends of runs are the candidate seeds of a raster scan for contours like findAllContours does:
+	// the first pixel of a run has background to its left, so it starts an outer or hole contour with dir 2,
+	// and the last pixel has background to its right, so it starts a hole or outer contour with dir 0, see findContour.
+	// A run starting at pixel x is found even if pixel x - 1 is foreground, so continue the search at last + 1.
+	// Rows are compared 16 or 32 pixels at once with SSE2 or AVX2 as available, see FECTS_SIMD.
+	//
+	// @param first Receives x coordinate of first pixel of the run.
+	// @param last Receives x coordinate of last pixel of the run.
+	// @param image, width, height, stride As in findContour.
+	// @param label Pixel values equal to this value are considered to be foreground.
+	// @param y Row to search.
+	// @param x Pixel to start the search with.
+	// @return False if there is no further run in the row; first and last are not changed then.
+	inline bool findRowRun(int& first, int& last, const uint8_t* const image, const int width, const int height, const int stride, const int label, int y, int x = 0)
+	{
+		FECTS_Assert(0 <= y && y < height, "row is outside of image");
+		FECTS_Assert(x >= 0, "x is negative");
+
+		const uint8_t* const row = image + size_t(y) * size_t(stride);
+		const int begin = findRowPixel(row, x, width, true, label);
+		if (begin >= width)
+			return false;
+		first = begin;
+		last = findRowPixel(row, begin + 1, width, false, label) - 1;
+		return true;
+	}
+
+	// Contour retrieval modes of findAllContours. Values are the same as in OpenCV cv::RetrievalModes.
+	enum retrieval_mode_t
+	{
+		RETR_EXTERNAL = 0, // only outer contours of objects not inside of a hole
+		RETR_LIST = 1, // all contours without hierarchy
+		RETR_CCOMP = 2, // two levels: outer contours at top level and their holes as children
+		RETR_TREE = 3, // full tree of nested contours
+	};
+
+	// Trace all contours of an image and return them like OpenCV cv::findContours with cv::CHAIN_APPROX_NONE does.
+	// Contour starts are found by a raster scan as described by Suzuki and Abe in
+	// "Topological Structural Analysis of Digitized Binary Images by Border Following" (1985).
+	// Each contour is traced with findContour, and its pixels are labeled to avoid tracing it twice
+	// and to find the parent of contours found later.
+	// Outer contours are traced counterclockwise starting with direction 2, inner contours start with direction 0.
+	//
+	// @param contours Receives the resulting contours. Existing content is cleared.
+	// TContours needs to implement a small sub-set of std::vector<std::vector<cv::Point>>:
+	//     typedef TContours::value_type; // TContour as needed by findContour, must be default constructible and movable
+	//     void TContours::clear()
+	//     void TContours::emplace_back(TContour&& contour)
+	//
+	// @param hierarchy Receives for each contour the indices of next and previous contour at the same level,
+	// of the first child contour, and of the parent contour; or -1 if there is none. Existing content is cleared.
+	// THierarchy needs to implement a small sub-set of std::vector<cv::Vec4i>:
+	//     void THierarchy::clear()
+	//     void THierarchy::emplace_back(int next, int previous, int first_child, int parent)
+	//
+	// @param image Pointer to image memory, 1 byte per pixel, row-major.
+	// @param width Width of image, i.e. image dimension in x coordinate.
+	// @param height Height of image, i.e. image dimension in y coordinate.
+	// @param stride Stride of image, i.e. offset between start of consecutive rows, i.e. width plus padding at the end of the image line, counted in pixels.
+	// @param label Label of the regions to trace.
+	//
+	// @param mode Contour retrieval mode, see retrieval_mode_t.
+	template<typename TContours, typename THierarchy>
+	void findAllContours(TContours& contours, THierarchy& hierarchy, const uint8_t* const image, const int width, const int height, const int stride, const int label, int mode = RETR_LIST)
+	{
+		FECTS_Assert(RETR_EXTERNAL <= mode && mode <= RETR_TREE, "retrieval mode is invalid");
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		typedef typename TContours::value_type TContour;
+
+		contours.clear();
+		hierarchy.clear();
+
+		// Border labels like in Suzuki's algorithm, but 0 is used for unlabeled foreground too.
+		// Border i (counting from 0 in order of discovery) uses nbd = i + 1.
+		std::vector<int> labels(size_t(width) * size_t(height), 0);
+
+		struct border_t
+		{
+			int parent; // index of parent border or -1 if parent is image frame
+			bool is_hole;
+		};
+		std::vector<border_t> borders;
+		std::vector<TContour> traced;
+
+		int* label_row = NULL;
+		// label of last labeled pixel in row; 0 stands for the image frame which is like a hole border
+		int lnbd = 0;
+
+		// check both start edges of foreground pixel (x,y) and trace their contours if they are not labeled yet
+		auto startContours = [&](int x, int y, bool is_left_foreground, bool is_right_foreground)
+		{
+			for (int is_hole = 0; is_hole < 2; is_hole++)
+			{
+				if (!is_hole)
+				{
+					// outer border starts at unlabeled pixel with background to the left
+					if (is_left_foreground || label_row[x] != 0)
+						continue;
+					if (mode == RETR_EXTERNAL && lnbd > 0)
+						continue; // inside of an object
+				}
+				else
+				{
+					// hole border starts at pixel with background to the right, unless that was examined before
+					if (is_right_foreground || label_row[x] < 0)
+						continue;
+					if (mode == RETR_EXTERNAL)
+						continue;
+					if (label_row[x] > 0)
+						lnbd = label_row[x];
+				}
+
+				int parent = -1;
+				if ((mode == RETR_CCOMP && is_hole) || mode == RETR_TREE)
+				{
+					// parent is last border or its parent, depending on the type of both borders
+					const bool is_lnbd_hole = lnbd == 0 || borders[abs(lnbd) - 1].is_hole;
+					parent = lnbd == 0 ? -1 : abs(lnbd) - 1;
+					if (is_lnbd_hole == (is_hole != 0) && parent >= 0)
+						parent = borders[parent].parent;
+				}
+
+				const int nbd = int(borders.size()) + 1;
+				borders.push_back({ parent, is_hole != 0 });
+				traced.emplace_back();
+				LabelingContour<TContour> contour(traced.back(), &labels[0], width, nbd);
+				findContour(contour, image, width, height, stride, label, x, y, is_hole ? 0 : 2, false, false, NULL);
+				contour.close();
+			}
+
+			if (label_row[x] != 0)
+				lnbd = label_row[x];
+		};
+
+		for (int y = 0; y < height; y++)
+		{
+			label_row = &labels[size_t(y) * size_t(width)];
+			lnbd = 0;
+
+			// contours start only at the ends of runs of foreground pixels; labels of pixels in between only update lnbd
+			int first;
+			int last;
+			for (int x = 0; findRowRun(first, last, image, width, height, stride, label, y, x); x = last + 1)
+			{
+				startContours(first, y, false, first < last);
+				if (first == last)
+					continue;
+				for (int i = last - 1; i > first; i--)
+				{
+					if (label_row[i] != 0)
+					{
+						lnbd = label_row[i];
+						break;
+					}
+				}
+				startContours(last, y, true, false);
+			}
+		}
+
+		// Like OpenCV, each contour is inserted in front of its siblings, and the contour tree is returned in pre-order.
+		const int count = int(borders.size());
+		std::vector<int> first_child(count + 1, -1); // last element is for top level contours
+		std::vector<int> next_sibling(count, -1);
+		std::vector<int> previous_sibling(count, -1);
+		for (int i = 0; i < count; i++)
+		{
+			int& first = first_child[borders[i].parent >= 0 ? borders[i].parent : count];
+			if (first >= 0)
+				previous_sibling[first] = i;
+			next_sibling[i] = first;
+			first = i;
+		}
+
+		std::vector<int> order;
+		order.reserve(count);
+		std::vector<int> index(count);
+		for (int i = first_child[count]; i >= 0; )
+		{
+			index[i] = int(order.size());
+			order.push_back(i);
+
+			if (first_child[i] >= 0)
+			{
+				i = first_child[i];
+			}
+			else
+			{
+				while (i >= 0 && next_sibling[i] < 0)
+					i = borders[i].parent;
+				if (i >= 0)
+					i = next_sibling[i];
+			}
+		}
+
+		for (int i: order)
+		{
+			contours.emplace_back(std::move(traced[i]));
+			hierarchy.emplace_back(
+				next_sibling[i] >= 0 ? index[next_sibling[i]] : -1,
+				previous_sibling[i] >= 0 ? index[previous_sibling[i]] : -1,
+				first_child[i] >= 0 ? index[first_child[i]] : -1,
+				borders[i].parent >= 0 ? index[borders[i].parent] : -1);
+		}
+	}
+
+	// Like findAllContours above, but with an image as in findContour.
+	template<typename TContours, typename THierarchy, typename TImage>
+	void findAllContours(TContours& contours, THierarchy& hierarchy, TImage const& image, const int label, int mode = RETR_LIST)
+	{
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		findAllContours(contours, hierarchy, image_ptr, width, height, stride, label, mode);
+	}
+
+	// Trace the outer contour of each label of a label image in a single pass over the image,
+	// e.g. of the connected components found by cv::connectedComponents.
+	// The seed of a label is its first pixel in raster order, so if a label has several 8-connected regions,
+	// only the outer contour of the topmost region (leftmost at equal rows) is traced.
+	// So the contour of a label is the outer contour of its first region, other regions of the label are not traced.
+	//
+	// @param contours Receives the resulting contours in order of their first pixel. Existing content is cleared.
+	// TContours needs to implement a small sub-set of std::vector<std::vector<cv::Point>>:
+	//     typedef TContours::value_type; // TContour as needed by findContour
+	//     void TContours::clear()
+	//     void TContours::emplace_back()
+	//     TContour& TContours::back()
+	//
+	// @param labels Receives for each contour its label.
+	//
+	// @param image, width, height, stride As in findContour.
+	// Labels below width * height, like those of connected component labeling, index a table of the labels traced already,
+	// larger labels are kept in a hash set, so memory is bounded by the image size. Negative labels are ignored.
+	//
+	// @param background Label of pixels that do not belong to any region; its contour is not traced.
+	// @param clockwise Indicates if outer contours are traced clockwise or counterclockwise, see findContour.
+	template<typename TContours>
+	void findLabelContours(TContours& contours, std::vector<int>& labels, const uint8_t* const image, const int width, const int height, const int stride, int background = 0, bool clockwise = false)
+	{
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		contours.clear();
+		labels.clear();
+
+		// start edge of the first pixel of a label is its left edge, since the pixel to its left has another label
+		const int dir = clockwise ? 0 : 2;
+
+		const size_t table_size = size_t(width) * size_t(height);
+		std::vector<uint8_t> is_traced;
+		std::unordered_set<int> traced_large_labels;
+		for (int y = 0; y < height; y++)
+		{
+			const uint8_t* const row = image + size_t(y) * size_t(stride);
+			for (int x = 0; x < width; x++)
+			{
+				// only the first pixel of a run of equal labels can be the first pixel of its label
+				if (x > 0 && row[x] == row[x - 1])
+					continue;
+
+				const int label = int(row[x]);
+				if (label == background || label < 0)
+					continue;
+				if (size_t(label) < table_size)
+				{
+					if (size_t(label) >= is_traced.size())
+						is_traced.resize(std::min(std::max(size_t(label) + 1, is_traced.size() * 2), table_size), 0);
+					if (is_traced[label])
+						continue;
+					is_traced[label] = 1;
+				}
+				else if (!traced_large_labels.insert(label).second)
+				{
+					continue;
+				}
+
+				contours.emplace_back();
+				labels.push_back(label);
+				findContour(contours.back(), image, width, height, stride, label, x, y, dir, clockwise);
+			}
+		}
+	}
+
+	// Like findLabelContours above, but with an image as in findContour.
+	template<typename TContours, typename TImage>
+	void findLabelContours(TContours& contours, std::vector<int>& labels, TImage const& image, int background = 0, bool clockwise = false)
+	{
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		findLabelContours(contours, labels, image_ptr, width, height, stride, background, clockwise);
+	}
+
+	// Trace the contours of many seed pixels, but trace each contour only once.
+	// Seeds are processed in order. The start edge of each seed is determined like findContour does.
+	// If it has been travelled already by the contour of an earlier seed, the seed gets the index of that contour.
+	// Otherwise a new contour is traced, and all later seeds on it are assigned to it too.
+	// Travelled edges are marked in a visited buffer by findContour, so total time is proportional to the total length
+	// of different contours, not to the number of seeds times contour length.
+	//
+	// @param contours Receives the resulting contours in order of first seed. Existing content is cleared.
+	// TContours needs to implement a small sub-set of std::vector<std::vector<cv::Point>>:
+	//     typedef TContours::value_type; // TContour as needed by findContour
+	//     void TContours::clear()
+	//     size_t TContours::size()
+	//     void TContours::emplace_back()
+	//     TContour& TContours::back()
+	//
+	// @param contour_indices Receives for each seed the index of its contour in contours.
+	//
+	// @param seeds Seed pixels.
+	// TSeeds needs to implement a small sub-set of std::vector<cv::Point>:
+	//     size_t TSeeds::size()
+	//     TSeed const& TSeeds::operator[](size_t index) // TSeed has int members x and y
+	//
+	// @param image Pointer to image memory, 1 byte per pixel, row-major.
+	// @param width Width of image, i.e. image dimension in x coordinate.
+	// @param height Height of image, i.e. image dimension in y coordinate.
+	// @param stride Stride of image, i.e. offset between start of consecutive rows, i.e. width plus padding at the end of the image line, counted in pixels.
+	// @param label Label of the regions to trace.
+	//
+	// @param dir Direction to start contour tracing with for all seeds, see findContour.
+	// @param clockwise Indicates if outer contours are traced clockwise or counterclockwise, see findContour.
+	template<typename TContours, typename TSeeds>
+	void findContours(TContours& contours, std::vector<int>& contour_indices, TSeeds const& seeds, const uint8_t* const image, const int width, const int height, const int stride, const int label, int dir = -1, bool clockwise = false)
+	{
+		typedef typename TContours::value_type TContour;
+
+		contours.clear();
+		const int seed_count = int(seeds.size());
+		contour_indices.assign(seed_count, -1);
+
+		std::vector<uint8_t> visited(size_t(stride) * size_t(height), 0);
+
+		// find start edges of seeds, mark them in visited, and sort them to find seeds by edge
+		std::vector<stop_t> starts(seed_count);
+		std::vector<std::pair<int64_t, int>> seed_edges(seed_count);
+		for (int i = 0; i < seed_count; i++)
+		{
+			NoContour no_contour;
+			stop_t& start = starts[i];
+			start.max_contour_length = 0;
+			findContour(no_contour, image, width, height, stride, label, seeds[i].x, seeds[i].y, dir, clockwise, false, &start);
+
+			const int index = start.x + start.y * stride;
+			visited[index] |= uint8_t(0x10 << start.dir);
+			seed_edges[i] = std::make_pair(int64_t(index) * 4 + start.dir, i);
+		}
+		std::sort(seed_edges.begin(), seed_edges.end());
+
+		for (int i = 0; i < seed_count; i++)
+		{
+			if (contour_indices[i] >= 0)
+				continue; // on contour of an earlier seed
+
+			const int contour_index = int(contours.size());
+			auto resolve = [&](int x, int y, int dir)
+			{
+				const int64_t edge = int64_t(x + y * stride) * 4 + dir;
+				auto it = std::lower_bound(seed_edges.begin(), seed_edges.end(), std::make_pair(edge, -1));
+				for (; it != seed_edges.end() && it->first == edge; ++it)
+					contour_indices[it->second] = contour_index;
+			};
+
+			contours.emplace_back();
+			SeedResolvingContour<TContour, decltype(resolve)> contour(contours.back(), &visited[0], stride, resolve);
+			const stop_t& start = starts[i];
+			findContour(contour, image, width, height, stride, label, start.x, start.y, start.dir, clockwise, false, NULL, &visited[0]);
+			contour.close(start.x, start.y);
+
+			FECTS_Assert(contour_indices[i] == contour_index, "seed is not on its contour");
+		}
+	}
+
+	// Like findContours above, but with an image as in findContour.
+	template<typename TContours, typename TSeeds, typename TImage>
+	void findContours(TContours& contours, std::vector<int>& contour_indices, TSeeds const& seeds, TImage const& image, const int label, int dir = -1, bool clockwise = false)
+	{
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		findContours(contours, contour_indices, seeds, image_ptr, width, height, stride, label, dir, clockwise);
+	}
+
+	// Trace the contour of each seed pixel like findContour does, using a pool of threads.
+	// Seeds are split into chunks which are distributed evenly to the threads. Threads that run out of work
+	// steal chunks from other threads. Each thread writes the points into its own buffer,
+	// and at the end the contours are copied to the result in seed order, so the result does not depend on scheduling.
+	// The image is only read, so tracing in parallel is safe.
+	//
+	// @param contours Receives one contour for each seed in seed order. Existing content is cleared.
+	// TContours needs to implement a small sub-set of std::vector<std::vector<cv::Point>>:
+	//     void TContours::clear()
+	//     void TContours::emplace_back()
+	//     TContour& TContours::back() // TContour as needed by findContour
+	//
+	// @param seeds Seed pixels.
+	// TSeeds needs to implement a small sub-set of std::vector<cv::Point>:
+	//     size_t TSeeds::size()
+	//     TSeed const& TSeeds::operator[](size_t index) // TSeed has int members x and y
+	//
+	// @param image Pointer to image memory, 1 byte per pixel, row-major.
+	// @param width Width of image, i.e. image dimension in x coordinate.
+	// @param height Height of image, i.e. image dimension in y coordinate.
+	// @param stride Stride of image, i.e. offset between start of consecutive rows, i.e. width plus padding at the end of the image line, counted in pixels.
+	// @param label Label of the regions to trace.
+	//
+	// @param dir Direction to start contour tracing with for all seeds, see findContour.
+	// @param clockwise Indicates if outer contours are traced clockwise or counterclockwise, see findContour.
+	// @param thread_count Number of threads to use including the calling thread. If value is 0, the number of hardware threads is used.
+	template<typename TContours, typename TSeeds>
+	void findContoursParallel(TContours& contours, TSeeds const& seeds, const uint8_t* const image, const int width, const int height, const int stride, const int label, int dir = -1, bool clockwise = false, int thread_count = 0)
+	{
+		contours.clear();
+
+		constexpr int chunk_size = 16; // seeds per work item
+		const int seed_count = int(seeds.size());
+		const int chunk_count = (seed_count + chunk_size - 1) / chunk_size;
+		if (thread_count <= 0)
+			thread_count = int(std::thread::hardware_concurrency());
+		thread_count = std::max(1, std::min(thread_count, chunk_count));
+
+		struct span_t
+		{
+			int thread_index; // index of buffer
+			int length; // number of points
+			size_t offset; // index of first x in buffer
+		};
+		std::vector<span_t> spans(seed_count);
+		std::vector<std::vector<int>> buffers(thread_count);
+		std::vector<std::exception_ptr> errors(thread_count);
+		std::vector<std::atomic<uint64_t>> ranges(thread_count);
+		for (int t = 0; t < thread_count; t++)
+			ranges[t].store(packRange(chunk_count * t / thread_count, chunk_count * (t + 1) / thread_count));
+
+		auto work = [&](int t)
+		{
+			try
+			{
+				FlatContour contour{ buffers[t] };
+				int chunk;
+				while (popItem(ranges[t], chunk) || stealItem(ranges, t, chunk))
+				{
+					const int end = std::min(seed_count, (chunk + 1) * chunk_size);
+					for (int i = chunk * chunk_size; i < end; i++)
+					{
+						const size_t offset = buffers[t].size();
+						findContour(contour, image, width, height, stride, label, seeds[i].x, seeds[i].y, dir, clockwise);
+						spans[i] = { t, int((buffers[t].size() - offset) / 2), offset };
+					}
+				}
+			}
+			catch (...)
+			{
+				errors[t] = std::current_exception();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (int t = 1; t < thread_count; t++)
+			threads.emplace_back(work, t);
+		work(0);
+		for (std::thread& thread: threads)
+			thread.join();
+
+		for (std::exception_ptr& error: errors)
+		{
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		for (int i = 0; i < seed_count; i++)
+		{
+			const span_t& span = spans[i];
+			const int* const points = buffers[span.thread_index].data() + span.offset;
+			contours.emplace_back();
+			auto& contour = contours.back();
+			for (int j = 0; j < span.length; j++)
+				contour.emplace_back(points[2 * j], points[2 * j + 1]);
+		}
+	}
+
+	// Like findContoursParallel above, but with an image as in findContour.
+	template<typename TContours, typename TSeeds, typename TImage>
+	void findContoursParallel(TContours& contours, TSeeds const& seeds, TImage const& image, const int label, int dir = -1, bool clockwise = false, int thread_count = 0)
+	{
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		findContoursParallel(contours, seeds, image_ptr, width, height, stride, label, dir, clockwise, thread_count);
+	}
+
+	// Trace all contours of an image like findAllContours with RETR_LIST does, but split the image into horizontal bands
+	// which are traced in parallel by a pool of threads like in findContoursParallel.
+	// Contours within a band are found by a raster scan of the band and traced with findContour.
+	// A contour crossing band seams is traced in fragments: each band traces a fragment from each edge (x, y, dir)
+	// where a contour enters the band up to the edge where it leaves the band, which is where the next fragment starts.
+	// These seam edges are used to stitch the fragments to full contours, which are rotated to start where the raster scan
+	// of findAllContours would have started them. The result is the same as with findAllContours and RETR_LIST.
+	// Travelled edges are marked in a visited buffer, like in findContours, but each band only writes its own rows.
+	//
+	// @param contours Receives the resulting contours. Existing content is cleared.
+	// TContours needs to implement a small sub-set of std::vector<std::vector<cv::Point>>:
+	//     void TContours::clear()
+	//     void TContours::emplace_back()
+	//     TContour& TContours::back() // TContour as needed by findContour
+	//
+	// @param hierarchy Receives for each contour the indices of next and previous contour, and -1 for first child and parent.
+	// Existing content is cleared.
+	// THierarchy needs to implement a small sub-set of std::vector<cv::Vec4i>:
+	//     void THierarchy::clear()
+	//     void THierarchy::emplace_back(int next, int previous, int first_child, int parent)
+	//
+	// @param image Pointer to image memory, 1 byte per pixel, row-major.
+	// @param width Width of image, i.e. image dimension in x coordinate.
+	// @param height Height of image, i.e. image dimension in y coordinate.
+	// @param stride Stride of image, i.e. offset between start of consecutive rows, i.e. width plus padding at the end of the image line, counted in pixels.
+	// @param label Label of the regions to trace.
+	//
+	// @param thread_count Number of threads to use including the calling thread. If value is 0, the number of hardware threads is used.
+	// @param band_height Number of rows of a band. If value is 0, a band height giving a few bands per thread is used.
+	template<typename TContours, typename THierarchy>
+	void findAllContoursParallel(TContours& contours, THierarchy& hierarchy, const uint8_t* const image, const int width, const int height, const int stride, const int label, int thread_count = 0, int band_height = 0)
+	{
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+		FECTS_Assert(band_height >= 0, "band height is negative");
+
+		contours.clear();
+		hierarchy.clear();
+
+		if (thread_count <= 0)
+			thread_count = int(std::thread::hardware_concurrency());
+		thread_count = std::max(1, thread_count);
+		if (band_height == 0)
+			band_height = std::max(16, (height + 4 * thread_count - 1) / (4 * thread_count));
+		const int band_count = (height + band_height - 1) / band_height;
+		thread_count = std::min(thread_count, band_count);
+
+		struct fragment_t
+		{
+			stop_t entry; // first edge of fragment
+			stop_t exit; // first edge after fragment, i.e. entry of next fragment; max_contour_length is number of points
+			int64_t first_start; // smallest rasterStartKey of fragment
+			int first_start_index; // number of points before edge of first_start
+			size_t offset; // index of first x in points of band
+		};
+		struct closed_t
+		{
+			int64_t start; // rasterStartKey of start edge
+			int length; // number of points
+			size_t offset; // index of first x in points of band
+		};
+		struct band_t
+		{
+			std::vector<int> points;
+			std::vector<fragment_t> fragments;
+			std::vector<closed_t> closed;
+		};
+		std::vector<band_t> bands(band_count);
+		std::vector<uint8_t> visited(size_t(stride) * size_t(height), 0);
+
+		auto traceBandContours = [&](int band_index)
+		{
+			band_t& band = bands[band_index];
+			FlatContour contour{ band.points };
+			const int y_begin = band_index * band_height;
+			const int y_end = std::min(height, y_begin + band_height);
+
+			// fragments of contours entering the band at its first or last row
+			for (int y = y_begin; y < y_end; y += std::max(1, y_end - 1 - y_begin))
+			{
+				for (int x = 0; x < width; x++)
+				{
+					if (!isForeground(x, y, image, width, height, stride, label))
+						continue;
+
+					for (int dir = 0; dir < 4; dir++)
+					{
+						if (isLeftForeground(x, y, dir, false, image, width, height, stride, label))
+							continue; // not a contour edge
+						if (visited[x + y * stride] & (1 << dir))
+							continue;
+						const int previous_y = previousContourRow(x, y, dir, image, width, height, stride, label);
+						if (previous_y >= y_begin && previous_y < y_end)
+							continue; // not entering the band
+
+						fragment_t fragment;
+						fragment.entry.x = fragment.exit.x = x;
+						fragment.entry.y = fragment.exit.y = y;
+						fragment.entry.dir = fragment.exit.dir = dir;
+						fragment.first_start = INT64_MAX;
+						fragment.first_start_index = 0;
+						fragment.offset = band.points.size();
+						fragment.exit.max_contour_length = traceBand(contour, fragment.exit.x, fragment.exit.y, fragment.exit.dir,
+							y_begin, y_end, &visited[0], fragment.first_start, fragment.first_start_index, image, width, height, stride, label);
+						band.fragments.push_back(fragment);
+					}
+				}
+			}
+
+			// contours within the band, found by raster scan for start edges not travelled yet
+			for (int y = y_begin; y < y_end; y++)
+			{
+				const int row = y * stride;
+				int first;
+				int last;
+				for (int x_begin = 0; findRowRun(first, last, image, width, height, stride, label, y, x_begin); x_begin = last + 1)
+				{
+					// start edges are the left edge of the first pixel of a run and the right edge of its last pixel
+					for (int dir = 2; dir >= 0; dir -= 2)
+					{
+						const int x = dir == 2 ? first : last;
+						if (visited[row + x] & (1 << dir))
+							continue;
+
+						const size_t offset = band.points.size();
+						findContour(contour, image, width, height, stride, label, x, y, dir, false, false, NULL, &visited[0]);
+						band.closed.push_back({ rasterStartKey(x, y, dir, width), int((band.points.size() - offset) / 2), offset });
+					}
+				}
+			}
+		};
+
+		std::vector<std::exception_ptr> errors(thread_count);
+		std::vector<std::atomic<uint64_t>> ranges(thread_count);
+		for (int t = 0; t < thread_count; t++)
+			ranges[t].store(packRange(band_count * t / thread_count, band_count * (t + 1) / thread_count));
+
+		auto work = [&](int t)
+		{
+			try
+			{
+				int band_index;
+				while (popItem(ranges[t], band_index) || stealItem(ranges, t, band_index))
+					traceBandContours(band_index);
+			}
+			catch (...)
+			{
+				errors[t] = std::current_exception();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (int t = 1; t < thread_count; t++)
+			threads.emplace_back(work, t);
+		work(0);
+		for (std::thread& thread: threads)
+			thread.join();
+
+		for (std::exception_ptr& error: errors)
+		{
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		// stitch fragments to contours by looking up the fragment that starts where a fragment ends
+		auto edgeKey = [&](const stop_t& edge) { return (int64_t(edge.y) * width + edge.x) * 4 + edge.dir; };
+		std::vector<std::pair<int64_t, std::pair<int, int>>> entries; // entry edge key, band index, fragment index
+		for (int b = 0; b < band_count; b++)
+		{
+			for (int f = 0; f < int(bands[b].fragments.size()); f++)
+				entries.push_back(std::make_pair(edgeKey(bands[b].fragments[f].entry), std::make_pair(b, f)));
+		}
+		std::sort(entries.begin(), entries.end());
+
+		struct contour_t
+		{
+			int64_t start; // rasterStartKey of start edge
+			int band_index; // band of closed contour, or -1 for stitched contour
+			int begin; // index of closed contour in band, or range [begin, end) of its fragments in stitched
+			int end;
+		};
+		std::vector<contour_t> result;
+		std::vector<std::pair<int, int>> stitched; // band index and fragment index, each cycle starts with fragment of start edge
+		std::vector<bool> is_stitched(entries.size(), false);
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			if (is_stitched[i])
+				continue;
+
+			const int begin = int(stitched.size());
+			int first = begin;
+			int64_t first_start = INT64_MAX;
+			for (size_t j = i; !is_stitched[j]; )
+			{
+				is_stitched[j] = true;
+				const fragment_t& fragment = bands[entries[j].second.first].fragments[entries[j].second.second];
+				if (fragment.first_start < first_start)
+				{
+					first_start = fragment.first_start;
+					first = int(stitched.size());
+				}
+				stitched.push_back(entries[j].second);
+
+				const int64_t next = edgeKey(fragment.exit);
+				j = size_t(std::lower_bound(entries.begin(), entries.end(), std::make_pair(next, std::make_pair(-1, -1))) - entries.begin());
+				FECTS_Assert(j < entries.size() && entries[j].first == next, "contour fragments do not match at band seam");
+			}
+
+			std::rotate(stitched.begin() + begin, stitched.begin() + first, stitched.end());
+			result.push_back({ first_start, -1, begin, int(stitched.size()) });
+		}
+		for (int b = 0; b < band_count; b++)
+		{
+			for (int c = 0; c < int(bands[b].closed.size()); c++)
+				result.push_back({ bands[b].closed[c].start, b, c, c + 1 });
+		}
+
+		// like findAllContours with RETR_LIST, the contour found last by raster scan comes first
+		std::sort(result.begin(), result.end(), [](const contour_t& a, const contour_t& b) { return a.start > b.start; });
+
+		const int count = int(result.size());
+		for (int i = 0; i < count; i++)
+		{
+			contours.emplace_back();
+			auto& contour = contours.back();
+			auto append = [&](const band_t& band, size_t offset, int begin, int end)
+			{
+				const int* const points = band.points.data() + offset;
+				for (int j = begin; j < end; j++)
+					contour.emplace_back(points[2 * j], points[2 * j + 1]);
+			};
+
+			const contour_t& c = result[i];
+			if (c.band_index >= 0)
+			{
+				const closed_t& closed = bands[c.band_index].closed[c.begin];
+				append(bands[c.band_index], closed.offset, 0, closed.length);
+			}
+			else
+			{
+				// from start edge to end of its fragment, all other fragments of the cycle, and the rest of the first fragment
+				const band_t& first_band = bands[stitched[c.begin].first];
+				const fragment_t& first = first_band.fragments[stitched[c.begin].second];
+				append(first_band, first.offset, first.first_start_index, first.exit.max_contour_length);
+				for (int f = c.begin + 1; f < c.end; f++)
+				{
+					const band_t& band = bands[stitched[f].first];
+					const fragment_t& fragment = band.fragments[stitched[f].second];
+					append(band, fragment.offset, 0, fragment.exit.max_contour_length);
+				}
+				append(first_band, first.offset, 0, first.first_start_index);
+			}
+
+			hierarchy.emplace_back(i + 1 < count ? i + 1 : -1, i - 1, -1, -1);
+		}
+	}
+
+	// Like findAllContoursParallel above, but with an image as in findContour.
+	template<typename TContours, typename THierarchy, typename TImage>
+	void findAllContoursParallel(TContours& contours, THierarchy& hierarchy, TImage const& image, const int label, int thread_count = 0, int band_height = 0)
+	{
+		// image properties
+		const int width = image.cols;
+		const int height = image.rows;
+		FECTS_Assert(width > 0 && height > 0, "image is empty");
+
+		int stride;
+		const uint8_t* const image_ptr = imagePointer(stride, image);
+
+		findAllContoursParallel(contours, hierarchy, image_ptr, width, height, stride, label, thread_count, band_height);
+	}
+
+} // namespace FECTS_L
@@ -1,6 +1,7 @@
 import os
 import sys
 import re
+import json
 from stat import S_IREAD, S_IWUSR
 import Preprocessor
 
@@ -10,32 +11,97 @@ output_file_of_variants = {
 	'bool': 'ContourTracing.hpp',
 	'thresh': 'ContourTracingThresh.hpp',
 	'bitonal': 'ContourTracingBitonal.hpp',
+	'thresh16': 'ContourTracingThresh16.hpp',
+	'threshfloat': 'ContourTracingThreshFloat.hpp',
+	'range': 'ContourTracingRange.hpp',
+	'range16': 'ContourTracingRange16.hpp',
+	'label': 'ContourTracingLabel.hpp',
+	'label16': 'ContourTracingLabel16.hpp',
+	'label32': 'ContourTracingLabel32.hpp',
 }
 
-variant = (sys.argv[1:2] or ['bool'])[0]
-out_folder = (sys.argv[2:3] or ['.'])[0]
-if len(sys.argv) not in (2, 3) or variant not in ('bool', 'thresh', 'bitonal'):
-	print("Usage: ContourTracingGenerator.py variant [out-folder]")
+# type of pixel values, type of threshold and the test of pixel values for the variants with one value per pixel:
+# 'nonzero', 'threshold' for value > threshold, 'range' for low < value <= high or 'label' for value == label
+pixel_type_of_variants = {
+	'bool': ('uint8_t', None, 'nonzero'),
+	'thresh': ('uint8_t', 'int', 'threshold'),
+	'thresh16': ('uint16_t', 'int', 'threshold'),
+	'threshfloat': ('float', 'float', 'threshold'),
+	'range': ('uint8_t', 'int', 'range'),
+	'range16': ('uint16_t', 'int', 'range'),
+	'label': ('uint8_t', 'int', 'label'),
+	'label16': ('uint16_t', 'int', 'label'),
+	'label32': ('int32_t', 'int', 'label'),
+}
+
+arguments = [a for a in sys.argv[1:] if not a.startswith('--')]
+options = [a for a in sys.argv[1:] if a.startswith('--')]
+variant = (arguments[0:1] or ['bool'])[0]
+out_folder = (arguments[1:2] or ['.'])[0]
+profile_file = None
+connectivity = '8'
+for option in options:
+	if option.startswith('--profile='):
+		profile_file = option[len('--profile='):]
+	if option.startswith('--connectivity='):
+		connectivity = option[len('--connectivity='):]
+if (len(arguments) not in (1, 2) or variant not in output_file_of_variants or connectivity not in ('4', '8') or
+		any(not o.startswith('--profile=') and not o.startswith('--connectivity=') for o in options)):
+	print("Usage: ContourTracingGenerator.py variant [out-folder] [--profile=rule-profile.json] [--connectivity=4]")
 	print("Possible values for variant are:")
 	print("  bool: input image is 1 byte per pixel and 0 is background; compatible with OpenCV")
 	print("  thresh: input image is 1 byte per pixel and values <= threshold are background; compatible with OpenCV")
 	print("  bitonal: input image is 1 bit per pixel and 0 is background")
+	print("  thresh16: input image is 2 bytes (uint16_t) per pixel and values <= threshold are background; compatible with OpenCV")
+	print("  threshfloat: input image is 4 bytes (float) per pixel and values <= threshold or NaN are background; compatible with OpenCV")
+	print("  range: input image is 1 byte per pixel and values low < value <= high are foreground; compatible with OpenCV")
+	print("  range16: input image is 2 bytes (uint16_t) per pixel and values low < value <= high are foreground; compatible with OpenCV")
+	print("  label, label16, label32: input image is a label image of 1, 2 or 4 bytes (int32_t) per pixel and values == label are foreground; compatible with OpenCV")
+	print("With a profile of rule hits, see ruleProfile and ContourTracingBenchmark --benchmark_rule_profile,")
+	print("the rules are tested in the order of their frequency and get branch hints.")
+	print("With --connectivity=4 foreground objects are 4-connected instead of 8-connected;")
+	print("the file name gets suffix 4 and the namespace gets suffix 4, e.g. ContourTracing4.hpp with namespace FECTS_4.")
 	exit(-1)
 
-output_file = os.path.abspath(os.path.join(directory, out_folder, output_file_of_variants[variant]))
+four_connected = connectivity == '4'
+
+# rule hits [clockwise][dir][rule] as counted with FECTS_PROFILE_RULES=1, or None for the default order of rules
+rule_profile = None
+if profile_file:
+	with open(profile_file) as f:
+		rule_profile = json.load(f)['rule_hits']
+	assert len(rule_profile) == 2 and all(len(d) == 4 and all(len(r) == 4 for r in d) for d in rule_profile), "bad rule profile"
+
+output_file_name = output_file_of_variants[variant]
+if four_connected:
+	output_file_name = output_file_name.replace('.hpp', '4.hpp')
+output_file = os.path.abspath(os.path.join(directory, out_folder, output_file_name))
 
 # pre-pre-preprocessing variables
+pixel_type, threshold_type, pixel_test = pixel_type_of_variants.get(variant, ('uint8_t', None, 'nonzero'))
+is_range = pixel_test == 'range'
+is_label = pixel_test == 'label'
+threshold_names = {'nonzero': [], 'threshold': ['threshold'], 'range': ['low', 'high'], 'label': ['label']}[pixel_test]
 ppvars = {
-	'o__ONE_BYTE_PER_PIXEL__o': '1' if variant != 'bitonal' else '0',
+	'o__ONE_BYTE_PER_PIXEL__o': '1' if variant != 'bitonal' and pixel_type == 'uint8_t' else '0',
 	'o__ONE_BIT_PER_PIXEL__o': '1' if variant == 'bitonal' else '0',
-	'o__THRESHOLD_IS_USED__o': '1' if variant == 'thresh' else '0',
-	'o__THRESHOLD_PARAMETER__o': "##, const int threshold" if variant == 'thresh' else "##",
-	'o__IMAGE_PARAMETER__o': "##, const uint8_t* const image, const int width, const int height, const int stride" + (
-		                     ", const int threshold" if variant == 'thresh' else ""),
+	'o__THRESHOLD_IS_USED__o': '1' if pixel_test == 'threshold' else '0',
+	'o__RANGE_IS_USED__o': '1' if is_range else '0',
+	'o__LABEL_IS_USED__o': '1' if is_label else '0',
+	'o__FOUR_CONNECTED__o': '1' if four_connected else '0',
+	'o__PIXEL_TYPE__o': pixel_type,
+	'o__PIXEL_TEXT__o': {'uint8_t': '8 bit', 'uint16_t': '16 bit', 'int32_t': '32 bit', 'float': '32 bit float'}[pixel_type],
+	'o__PIXEL_SIZE_TEXT__o': '1 bit' if variant == 'bitonal' else {'uint8_t': '1 byte', 'uint16_t': '2 bytes', 'int32_t': '4 bytes', 'float': '4 bytes'}[pixel_type],
+	'o__THRESHOLD_TYPE__o': threshold_type or 'int',
+	'o__THRESHOLD_PARAMETER__o': "##" + "".join(", const {} {}".format(threshold_type, name) for name in threshold_names),
+	'o__THRESHOLD_ARGUMENTS__o': "##" + "".join(", " + name for name in threshold_names),
+	'o__IMAGE_PARAMETER__o': "##, const {}* const image, const int width, const int height, const int stride".format(pixel_type) + (
+		                     "".join(", const {} {}".format(threshold_type, name) for name in threshold_names)),
 	'o__IMAGE_ARGUMENTS__o': "##, image, width, height, stride" + (
-		                     ", threshold" if variant == 'thresh' else ""),
+		                     "".join(", " + name for name in threshold_names)),
 }
 ppvars['o__IMAGE_PTR_ARGUMENTS__o'] = re.sub(r"\bimage\b", "image_ptr", ppvars['o__IMAGE_ARGUMENTS__o'])
+ppvars['o__VISITED_INDEX__o'] = "pixel - image" if variant != 'bitonal' else "pixel"
 
 print('ContourTracingGenerator.py -> {}'.format(output_file))
 
@@ -43,8 +109,24 @@ namespace = "FECTS"
 namespace_ = namespace + "_"
 if variant == 'thresh':
 	namespace += "_T"
+if variant == 'thresh16':
+	namespace += "_T16"
+if variant == 'threshfloat':
+	namespace += "_TF"
+if variant == 'range':
+	namespace += "_R"
+if variant == 'range16':
+	namespace += "_R16"
+if variant == 'label':
+	namespace += "_L"
+if variant == 'label16':
+	namespace += "_L16"
+if variant == 'label32':
+	namespace += "_L32"
 if variant == 'bitonal':
 	namespace += "_B"
+if four_connected:
+	namespace += "4" if namespace != "FECTS" else "_4"
 
 def strip_parentheses(term):
 	term = term.strip()
@@ -128,6 +210,13 @@ def forward_pixel(dir, clockwise):
 def forward_left_pixel(dir, clockwise):
 	return offset_pixel(forward_left_vector(dir, clockwise))
 
+def chain_code(vec):
+	# chain code of a move to a neighbor pixel as used by OpenCV: 0 is right, 2 is up, 4 is left, 6 is down
+	return {(1, 0): 0, (1, -1): 1, (0, -1): 2, (-1, -1): 3, (-1, 0): 4, (-1, 1): 5, (0, 1): 6, (1, 1): 7}[vec]
+
+def emit_move_code(vec):
+	return 'emplaceBackMove(contour, x, y, {});'.format(chain_code(vec))
+
 def pixel_off_code(vec):
 	sign = {-1: 'm', 0: '0', 1: 'p'}
 	return "off_" + sign[vec[0]] + sign[vec[1]]
@@ -140,7 +229,14 @@ def is_value_foreground_code(value_code):
 			return "bittest(image, {})".format(array_index)
 		return "bittest(image, {} + {})".format(check_parentheses(array_pointer), check_parentheses(array_index))
 
-	if variant == 'thresh':
+	if is_range:
+		# low < value <= high with a single unsigned compare; the compiler hoists low + 1 and high - low out of loops
+		return "unsigned({} - low - 1) < unsigned(high - low)".format(value_code)
+
+	if is_label:
+		return "{} == label".format(value_code)
+
+	if threshold_type:
 		return "{} > threshold".format(value_code)
 
 	assert variant == 'bool'
@@ -149,6 +245,26 @@ def is_value_foreground_code(value_code):
 def is_pixel_foreground_code(vec):
 	return is_value_foreground_code("pixel[{}]".format(pixel_off_code(vec)))
 
+def is_pixel_background_code(vec):
+	code = is_pixel_foreground_code(vec)
+	if variant == 'bitonal':
+		return '!' + code
+	if threshold_type == 'float':
+		return '!({})'.format(code)  # NaN is neither above nor below threshold, but it is background
+	if is_range:
+		return code.replace(' < ', ' >= ')
+	if is_label:
+		return code.replace(' == ', ' != ')
+	return code.replace(' > ', ' <= ') if threshold_type else code.replace(' != ', ' == ')
+
+def stop_predicate_code_lines():
+	return [
+		'    // stop if stop predicate says so for the pixel moved to',
+		'    if (has_stop_predicate && (stop_reason = stop_predicate(x, y)) != 0)',
+		'        break;',
+	]
+
+
 def move_pixel_code_lines(vec, indent):
 	lines = []
 	lines.append("pixel += {};".format(pixel_off_code(vec)))
@@ -236,6 +352,13 @@ direction 0 basic clockwise rules:
                      - turn left          - move ahead         - turn right
                      - emit pixel (x,y)   - emit pixel (x,y)
 """
+		if four_connected:
+			# rule 1 also needs the forward pixel, since the forward-left pixel only touching the corner is not connected
+			basic_rules_0cw = basic_rules_0cw.replace(
+				"|   1   |  0/1  |    |   0   |   1   |    |   0   |   0   |",
+				"|   1   |   1   |    |   0   |   1   |    |  0/1  |   0   |").replace(
+				"|  ???  |       |    |       |  ???  |    |       |  ???  |",
+				"|  ???  |  ???  |    |  ???  |  ???  |    |       |  ???  |")
 		title = '\n'.join(prefix + l for l in basic_rules_0cw.splitlines()[1:]) + '\n\n\n' + title
 
 
@@ -259,6 +382,10 @@ rule 0:              rule 1:              rule 2:              rule 3:
 	rule1 = (('1', '0/1', '1', '0'), ('???', '', '(x,y)', ''), ('|', '-', '^', '-'), ('|', '-', '|', '<'), 'left', 'emit')
 	rule2 = (('0/b', '1', '1', '0/b'), ('', '???', '(x,y)', ''), ('|', '-', '^', '-'), ('^', '-', '|', '-'), '', 'emit')
 	rule3 = (('0/b', '0', '1', '0/b'), ('', '???', '(x,y)', ''), ('|', '-', '^', '-'), ('|', '>', '|', '-'), 'right', '')
+	if four_connected:
+		rule1 = (('1', '1', '1', '0'), ('???', '???', '(x,y)', ''), ('|', '-', '^', '-'), ('|', '-', '|', '<'), 'left', 'emit')
+		rule2 = (('0/b', '1', '1', '0/b'), ('???', '???', '(x,y)', ''), ('|', '-', '^', '-'), ('^', '-', '|', '-'), '', 'emit')
+		rule3 = (('0/1/b', '0', '1', '0/b'), ('', '???', '(x,y)', ''), ('|', '-', '^', '-'), ('|', '>', '|', '-'), 'right', '')
 	ascii_art_rules = [rule0, rule1, rule2, rule3]
 
 	blocks = [make_rule_ascii_art(i, rule, dir, clockwise) for i, rule in enumerate(ascii_art_rules)]
@@ -280,27 +407,72 @@ rule 0:              rule 1:              rule 2:              rule 3:
 	lines = [prefix + ''.join(b[l] for b in blocks).rstrip() for l in range(maxlines)]
 	return title + '\n'.join(lines);
 
-def make_rules_code(dir, clockwise, indent):
+def count_rule_code_lines(dir, clockwise, rule):
+	# count rule in rule_hits[clockwise][dir][rule] if profiling is enabled, see ruleProfile
+	return ['    if ({}PROFILE_RULES)'.format(namespace_),
+	        '        ++rule_hits[{}];'.format((16 if clockwise else 0) + dir * 4 + rule)]
+
+def rule_order(dir, clockwise, use_profile):
+	# rules 1 to 3 in the order they are tested after rule 0, most frequent first if there is a profile;
+	# for 4-connected objects rule 3 is tested first by default, since it only needs the forward pixel
+	default_order = [3, 1, 2] if four_connected else [1, 2, 3]
+	if rule_profile is None or not use_profile:
+		return default_order
+	hits = rule_profile[int(clockwise)][dir]
+	return sorted(default_order, key=lambda rule: -hits[rule])  # stable, so the default order is kept for equal hits
+
+def branch_hint_code(condition, dir, clockwise, rule, rules_left, use_profile):
+	# wrap condition of rule in a branch hint if the profile shows that the branch is almost always
+	# or almost never taken when it is reached, i.e. none of the rules tested before applied
+	if rule_profile is None or not use_profile:
+		return condition
+	hits = rule_profile[int(clockwise)][dir]
+	reached = sum(hits[r] for r in rules_left)
+	if reached == 0:
+		return condition
+	probability = hits[rule] / reached
+	if probability >= 0.9:
+		return '{}LIKELY({})'.format(namespace_, condition)
+	if probability <= 0.1:
+		return '{}UNLIKELY({})'.format(namespace_, condition)
+	return condition
+
+def rule_share_comment(dir, clockwise, rule, use_profile):
+	if rule_profile is None or not use_profile:
+		return ''
+	hits = rule_profile[int(clockwise)][dir]
+	return ', {:.1f}% of steps'.format(100.0 * hits[rule] / max(1, sum(hits)))
+
+def make_rules_code(dir, clockwise, indent, use_profile=True):
 	left = 'left' if clockwise else 'right'
 	right = 'right' if clockwise else 'left'
 
+	# code and description of the conditions of rules 1 to 3 after rule 0 did not apply
+	is_rule1_code = '{} && {}'.format(is_left_not_border_code(dir, clockwise), is_pixel_foreground_code(forward_left_vector(dir, clockwise)))
+	is_rule1_text = '{0} is not border and forward-{0} pixel is foreground'.format(left)
+	is_not_rule1_code = '!({})'.format(is_rule1_code)
+	is_not_rule1_text = '{0} is border or forward-{0} pixel is background'.format(left)
+	is_forward_code = is_pixel_foreground_code(forward_vector(dir, clockwise))
+	is_forward_text = 'forward pixel is foreground'
+	is_not_forward_code = is_pixel_background_code(forward_vector(dir, clockwise))
+	is_not_forward_text = 'forward pixel is background'
+
+	rule_lines = {}
+
 	lines = []
-	lines.append('// if forward is border (rule 0)')
-	lines.append('if ({})'.format(is_forward_border_code(dir)))
-	lines.append('{')
+	lines += count_rule_code_lines(dir, clockwise, 0)
 	lines.append('    // turn {}'.format(right))
 	new_dir = turn_right(dir, clockwise)
 	lines.append('    dir = {};'.format(new_dir))
 	if (sorted([dir, new_dir]) == [0, 3]):
 		lines.append('    {}sum_of_turn_overflows;'.format('++' if (new_dir < dir) == clockwise else '--'))
 	#lines.append('    ++sum_of_turns;')
-	lines.append('}')
-	lines.append('// else if {0} is not border and forward-{0} pixel is foreground (rule 1)'.format(left))
-	lines.append('else if ({} && {})'.format(is_left_not_border_code(dir, clockwise),
-											 is_pixel_foreground_code(forward_left_vector(dir, clockwise))))
-	lines.append('{')
+	rule_lines[0] = lines
+
+	lines = []
+	lines += count_rule_code_lines(dir, clockwise, 1)
 	lines.append('    // emit current pixel')
-	lines.append('    contour.emplace_back(x, y);')
+	lines.append('    ' + emit_move_code(forward_left_vector(dir, clockwise)))
 	lines.append('    // go to checked pixel');
 	lines += move_pixel_code_lines(forward_left_vector(dir, clockwise), '    ');
 	lines.append('    // turn {}'.format(left));
@@ -309,33 +481,41 @@ def make_rules_code(dir, clockwise, indent):
 	#lines.append('    --sum_of_turns;')
 	if (sorted([dir, new_dir]) == [0, 3]):
 		lines.append('    {}sum_of_turn_overflows;'.format('++' if (new_dir < dir) == clockwise else '--'))
-	lines.append('    // stop if buffer is full')
-	lines.append('    if (++contour_length >= max_contour_length)')
-	lines.append('        break;')
 	lines.append('    // set pixel valid');
 	lines.append('    is_pixel_valid = true;');
-	lines.append('}')
-	lines.append('// else if forward pixel is foreground (rule 2)')
-	lines.append('else if ({})'.format(is_pixel_foreground_code(forward_vector(dir, clockwise))))
-	lines.append('{')
+	lines.append('    // stop if buffer is full')
+	lines.append('    if (++contour_length >= max_contour_length && has_length_limit)')
+	lines.append('        break;')
+	lines += stop_predicate_code_lines()
+	rule_lines[1] = lines
+
+	lines = []
+	lines += count_rule_code_lines(dir, clockwise, 2)
 	lines.append('    // if pixel is valid')
-	lines.append('    if (is_pixel_valid)')
+	lines.append('    if (!do_suppress_border || is_pixel_valid)')
 	lines.append('    {')
 	lines.append('        // emit current pixel')
-	lines.append('        contour.emplace_back(x, y);')
+	lines.append('        ' + emit_move_code(forward_vector(dir, clockwise)))
 	lines.append('    }')
 	lines.append('    // go to checked pixel');
 	lines += move_pixel_code_lines(forward_vector(dir, clockwise), '    ');
-	lines.append('    // stop if buffer is full')
-	lines.append('    if (++contour_length >= max_contour_length)' + (' // contour_length is the unsuppressed length' if dir == 0 and clockwise else ''))
-	lines.append('        break;')
 	lines.append('    // if border is to be suppressed, set pixel valid if {} is not border'.format(left))
 	lines.append('    if (do_suppress_border)')
 	lines.append('        is_pixel_valid = {};'.format(is_left_not_border_code(dir, clockwise)))
-	lines.append('}')
-	lines.append('// else (rule 3)')
-	lines.append('else')
-	lines.append('{')
+	lines.append('    // stop if buffer is full')
+	lines.append('    if (++contour_length >= max_contour_length && has_length_limit)' + (' // contour_length is the unsuppressed length' if dir == 0 and clockwise else ''))
+	lines.append('        break;')
+	lines += stop_predicate_code_lines()
+	if variant == 'bitonal' and dir in (1, 3):
+		lines.append('    // continue along the row as long as rule 2 applies, testing whole words; a stop predicate needs to see each pixel and edge output each edge')
+		lines.append('    if ({}BITONAL_WORD_ENGINE && !has_stop_predicate && !has_edge_output && traceRowRun(contour, image, width, height, stride, pixel, x, y, {}, clockwise,'.format(namespace_, dir))
+		lines.append('            do_suppress_border, is_pixel_valid, contour_length, max_contour_length, has_length_limit,')
+		lines.append('            start_x, start_y, start_dir, stop_x, stop_y, stop_dir, visited))')
+		lines.append('        break;')
+	rule_lines[2] = lines
+
+	lines = []
+	lines += count_rule_code_lines(dir, clockwise, 3)
 	lines.append('    // turn {}'.format(right))
 	new_dir = turn_right(dir, clockwise)
 	lines.append('    dir = {};'.format(new_dir))
@@ -343,14 +523,154 @@ def make_rules_code(dir, clockwise, indent):
 	if (sorted([dir, new_dir]) == [0, 3]):
 		lines.append('    {}sum_of_turn_overflows;'.format('++' if (new_dir < dir) == clockwise else '--'))
 	lines.append('    // set pixel valid if {} is not border'.format(left))
-	lines.append('    if (!is_pixel_valid)')
+	lines.append('    if (do_suppress_border && !is_pixel_valid)')
 	lines.append('        is_pixel_valid = {};'.format(is_left_not_border_code(new_dir, clockwise)))
+	rule_lines[3] = lines
+
+	# Rule 0 is always tested first, since the other rules read pixels beyond the forward border.
+	# Rules 1 to 3 can be tested in any order if each condition excludes the rules tested after it:
+	# rule 1 is tested as is, rule 2 and 3 also need that rule 1 does not apply unless it was tested before.
+	order = rule_order(dir, clockwise, use_profile)
+	if four_connected:
+		# Rule 1 needs the forward pixel to be foreground too, so rule 3 only tests the forward pixel.
+		# Rules 1 and 2 need to test the forward pixel unless rule 3 was tested before.
+		conditions = {3: (is_not_forward_code, is_not_forward_text)}
+		is_forward_tested = order.index(3) < order.index(1)
+		conditions[1] = (is_rule1_code, is_rule1_text) if is_forward_tested else (
+			'{} && {}'.format(is_forward_code, is_rule1_code), '{} and {}'.format(is_forward_text, is_rule1_text))
+		is_forward_tested = order.index(3) < order.index(2)
+		if order.index(1) < order.index(2):
+			conditions[2] = (is_forward_code, is_forward_text)
+		elif is_forward_tested:
+			conditions[2] = (is_not_rule1_code, is_not_rule1_text)
+		else:
+			conditions[2] = ('{} && {}'.format(is_forward_code, is_not_rule1_code), '{} and ({})'.format(is_forward_text, is_not_rule1_text))
+	elif order[0] == 1:
+		conditions = {1: (is_rule1_code, is_rule1_text), 2: (is_forward_code, is_forward_text), 3: (is_not_forward_code, is_not_forward_text)}
+	else:
+		conditions = {
+			order[0]: ('{} && {}'.format(*((is_forward_code, is_not_rule1_code) if order[0] == 2 else (is_not_forward_code, is_not_rule1_code))),
+			           '{} and ({})'.format(*((is_forward_text, is_not_rule1_text) if order[0] == 2 else (is_not_forward_text, is_not_rule1_text)))),
+			1: (is_rule1_code, is_rule1_text),
+		}
+		conditions[6 - order[0] - 1] = (is_not_rule1_code, is_not_rule1_text)
+
+	lines = []
+	lines.append('// if forward is border (rule 0{})'.format(rule_share_comment(dir, clockwise, 0, use_profile)))
+	lines.append('if ({})'.format(branch_hint_code(is_forward_border_code(dir), dir, clockwise, 0, [0, 1, 2, 3], use_profile)))
+	lines.append('{')
+	lines += rule_lines[0]
 	lines.append('}')
+	for index, rule in enumerate(order):
+		share = rule_share_comment(dir, clockwise, rule, use_profile)
+		if index + 1 < len(order):
+			code, text = conditions[rule]
+			lines.append('// else if {} (rule {}{})'.format(text, rule, share))
+			lines.append('else if ({})'.format(branch_hint_code(code, dir, clockwise, rule, order[index:], use_profile)))
+		else:
+			lines.append('// else (rule {}{})'.format(rule, share))
+			lines.append('else')
+		lines.append('{')
+		lines += rule_lines[rule]
+		lines.append('}')
+	return '\n'.join(indent + l for l in lines)
+
+
+def make_framed_rules_code(dir, clockwise, indent):
+	# rules for images with a frame of background pixels: no border checks, no border suppression,
+	# and only the pixel pointer is moved; x and y are computed from it when a pixel is emitted
+	left = 'left' if clockwise else 'right'
+	right = 'right' if clockwise else 'left'
+	emit = 'emplaceBackIndex(contour, {}, stride);'.format(ppvars['o__VISITED_INDEX__o'])
+
+	rule_lines = {}
+
+	lines = []
+	lines.append('    // emit current pixel')
+	lines.append('    ' + emit)
+	lines.append('    // go to checked pixel');
+	lines.append('    pixel += {};'.format(pixel_off_code(forward_left_vector(dir, clockwise))))
+	lines.append('    // turn {}'.format(left));
+	new_dir = turn_left(dir, clockwise)
+	lines.append('    dir = {};'.format(new_dir))
+	if (sorted([dir, new_dir]) == [0, 3]):
+		lines.append('    {}sum_of_turn_overflows;'.format('++' if (new_dir < dir) == clockwise else '--'))
+	lines.append('    // stop if buffer is full')
+	lines.append('    if (++contour_length >= max_contour_length)')
+	lines.append('        break;')
+	rule_lines[1] = lines
+
+	lines = []
+	lines.append('    // emit current pixel')
+	lines.append('    ' + emit)
+	lines.append('    // go to checked pixel');
+	lines.append('    pixel += {};'.format(pixel_off_code(forward_vector(dir, clockwise))))
+	lines.append('    // stop if buffer is full')
+	lines.append('    if (++contour_length >= max_contour_length)')
+	lines.append('        break;')
+	rule_lines[2] = lines
+
+	lines = []
+	lines.append('    // turn {}'.format(right))
+	new_dir = turn_right(dir, clockwise)
+	lines.append('    dir = {};'.format(new_dir))
+	if (sorted([dir, new_dir]) == [0, 3]):
+		lines.append('    {}sum_of_turn_overflows;'.format('++' if (new_dir < dir) == clockwise else '--'))
+	rule_lines[3] = lines
+
+	# for 4-connected objects rule 3 is tested first, so rule 1 does not need to test the forward pixel again
+	if four_connected:
+		order = [3, 1, 2]
+		conditions = {
+			3: (is_pixel_background_code(forward_vector(dir, clockwise)), 'forward pixel is background'),
+			1: (is_pixel_foreground_code(forward_left_vector(dir, clockwise)), 'forward-{} pixel is foreground'.format(left)),
+		}
+	else:
+		order = [1, 2, 3]
+		conditions = {
+			1: (is_pixel_foreground_code(forward_left_vector(dir, clockwise)), 'forward-{} pixel is foreground'.format(left)),
+			2: (is_pixel_foreground_code(forward_vector(dir, clockwise)), 'forward pixel is foreground'),
+		}
+
+	lines = []
+	for index, rule in enumerate(order):
+		if index + 1 < len(order):
+			code, text = conditions[rule]
+			lines.append('// {}if {} (rule {})'.format('else ' if index else '', text, rule))
+			lines.append('{}if ({})'.format('else ' if index else '', code))
+		else:
+			lines.append('// else (rule {})'.format(rule))
+			lines.append('else')
+		lines.append('{')
+		lines += rule_lines[rule]
+		lines.append('}')
 	return '\n'.join(indent + l for l in lines)
 
 
-def make_rules_code_summary(dir, clockwise, indent):
-	lines = [l for l in make_rules_code(dir, clockwise, indent).splitlines() if re.search(r"^\s*//", l)]
+def make_lookup_steps_code(indent):
+	# table of the lookup table engine, indexed by [clockwise][dir * 4 + forward-left pixel * 2 + forward pixel]
+	# giving { next dir, dx, dy, rule, turn } with the same rules as the generic trace loop
+	lines = []
+	for clockwise in (False, True):
+		lines.append('// {}'.format('clockwise' if clockwise else 'counterclockwise'))
+		lines.append('{')
+		for dir in range(4):
+			for forward_left in (0, 1):
+				for forward in (0, 1):
+					if forward_left and (forward or not four_connected):
+						rule, (dx, dy), new_dir, turn = 1, forward_left_vector(dir, clockwise), turn_left(dir, clockwise), -1
+					elif forward:
+						rule, (dx, dy), new_dir, turn = 2, forward_vector(dir, clockwise), dir, 0
+					else:
+						rule, (dx, dy), new_dir, turn = 3, (0, 0), turn_right(dir, clockwise), 1
+					lines.append('    {{ {}, {: d}, {: d}, {}, {: d} }}, // dir {}, forward-{} {}, forward {}'.format(
+						new_dir, dx, dy, rule, turn, dir, 'left' if clockwise else 'right', forward_left, forward))
+		lines.append('},')
+	return '\n'.join(indent + l for l in lines)
+
+
+def make_rules_code_summary(dir, clockwise, indent, use_profile=True):
+	lines = [l for l in make_rules_code(dir, clockwise, indent, use_profile).splitlines() if re.search(r"^\s*//", l)]
 	return '\n'.join(l.replace("// ", "", 1) for l in lines)
 
 
@@ -369,7 +689,7 @@ def make_trace_generic_comment_code(indent):
 	code = indent + "/*\n"
 	code += make_rules_ascii_art(0, True, indent) + "\n"
 	code += "\n"
-	code += make_rules_code_summary(0, True, indent) + "\n"
+	code += make_rules_code_summary(0, True, indent, False) + "\n"
 	code += "\n"
 	code += indent + "In case of counterclockwise tracing the rules are the same except that left and right are exchanged.\n"
 	code += indent + "*/"
@@ -413,6 +733,19 @@ for line_index, line in enumerate(lines):
 		lines[line_index] = make_trace_step_code(int(dir), clockwise == 'CW', indent)
 		continue
 
+	m = re.match(r'^(\s*)(.*)\bo__TRACE_FRAMED_STEP_(C?CW)_DIR_([0-3])__o\b\s*;\s*(.*)$', line)
+	if m:
+		indent, code_before, clockwise, dir, code_after = m.groups()
+		assert not code_before
+		assert not code_after
+		lines[line_index] = make_framed_rules_code(int(dir), clockwise == 'CW', indent)
+		continue
+
+	m = re.match(r'^(\s*)o__LOOKUP_STEPS__o\s*$', line)
+	if m:
+		lines[line_index] = make_lookup_steps_code(m.group(1))
+		continue
+
 	m = re.match(r'^(\s*)(.*)\bo__TRACE_GENERIC_COMMENT__o\b\s*;\s*(.*)$', line)
 	if m:
 		indent, code_before, code_after = m.groups()
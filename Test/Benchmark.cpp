@@ -0,0 +1,528 @@
+//
+// Copyright 2024 Axel Walthelm
+//
+// Benchmark of findContour for all variants on random images of different sizes and foreground densities.
+// Each contour found in the image is traced from its start point like Test.cpp does, and the time is
+// accumulated in bins of contour length. Results are printed as table and, like Google Benchmark does,
+// written as JSON if requested:
+//
+//   ContourTracingBenchmark [--benchmark_out=<file>] [--benchmark_format=<console|json>] [--benchmark_repetitions=<n>]
+//                           [--benchmark_perf_counters] [--benchmark_rule_profile=<file>]
+//
+// OpenCV cv::findContours is measured if FECTS_BENCHMARK_OPENCV is 1.
+// With --benchmark_perf_counters each engine does one more pass that reads hardware performance counters
+// (instructions, cycles, branch misses, cache misses) around each call instead of the timer, see PerfCounters.h.
+// Counters that are not available are reported as null in JSON.
+// With --benchmark_rule_profile the rules applied by engine FECTS are counted, see FECTS::ruleProfile,
+// and written as JSON for Generator.py --profile. This needs FECTS_PROFILE_RULES=1, see ContourTracingProfile in CMakeLists.txt.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <random>
+#include <limits>
+#include <thread>
+#include <stdexcept>
+#include "HighResolutionTimer.h"
+#include "PerfCounters.h"
+#include "LogBins.hpp"
+#include "BitonalImage.hpp"
+
+#ifndef FECTS_BENCHMARK_OPENCV
+#define FECTS_BENCHMARK_OPENCV 0
+#endif
+#if FECTS_BENCHMARK_OPENCV
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+#endif
+
+#define FECTS_Assert(expr,msg) do { if(!!(expr)) ; else throw std::runtime_error(msg); } while(0)
+#define FECTS_GENERATOR_OPTIMIZED 1
+// not relative to this file, so ContourTracingBenchmarkTuned can include headers generated with a rule profile
+#include "ContourTracing.hpp"
+#include "ContourTracingThresh.hpp"
+#include "ContourTracingBitonal.hpp"
+
+struct Point
+{
+	int x;
+	int y;
+	Point(int x, int y) : x(x), y(y) {}
+};
+
+struct Links
+{
+	int next, previous, first_child, parent;
+	Links(int next, int previous, int first_child, int parent) : next(next), previous(previous), first_child(first_child), parent(parent) {}
+};
+
+// Random image with blobs of foreground pixels (255) like setRandom of Test.cpp.
+void setRandom(std::vector<uint8_t>& image, int width, int height, double density, std::mt19937& random)
+{
+	std::uniform_real_distribution<double> uniform;
+	for (uint8_t& p : image)
+		p = uniform(random) < density ? 255 : 0;
+
+	for (int todo = int(width * height * 0.5); todo > 0; todo--)
+	{
+		const int x = int(random() % unsigned(width));
+		const int y = int(random() % unsigned(height));
+
+		int sum = 0;
+		int count = 0;
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if (unsigned(x + dx) >= unsigned(width) || unsigned(y + dy) >= unsigned(height))
+					continue;
+
+				sum += image[(x + dx) + (y + dy) * width] != 0;
+				count += 1;
+			}
+		}
+
+		image[x + y * width] = sum * 2 > count ? 255 : 0;
+	}
+}
+
+// Time, performance counters, and traced pixels of one engine, in total and per bin of contour length.
+struct Result
+{
+	std::string engine;
+	int width = 0;
+	int height = 0;
+	double density = 0;
+	int repetitions = 0;
+	uint64_t ns = 0;
+	uint64_t pixels = 0;
+	PerfCounterValues_t counters; // of pass with counters
+	uint64_t counted_pixels = 0; // pixels of pass with counters
+	LogBinSums<uint64_t> bin_ns; // time and pixels per bin
+	LogBinSums<PerfCounterValues_t> bin_counters; // of pass with counters
+
+	void add(int bin, uint64_t duration, size_t count)
+	{
+		bin_ns.add(bin, duration, count);
+		ns += duration;
+		pixels += count;
+	}
+
+	void add(int bin, const PerfCounterValues_t& values, size_t count)
+	{
+		bin_counters.add(bin, values, count);
+		counters += values;
+		counted_pixels += count;
+	}
+
+	PerfCounterValues_t binCounters(int bin) const
+	{
+		return bin < bin_counters.size() ? bin_counters.values[bin] : PerfCounterValues_t();
+	}
+
+	uint64_t binCountedPixels(int bin) const
+	{
+		return bin < bin_counters.size() ? bin_counters.counts[bin] : 0;
+	}
+
+	std::string name() const
+	{
+		char buffer[128];
+		snprintf(buffer, sizeof(buffer), "%s/%dx%d/density:%.2f", engine.c_str(), width, height, density);
+		return buffer;
+	}
+};
+
+double nsPerPixel(uint64_t ns, uint64_t pixels)
+{
+	return pixels > 0 ? double(ns) / double(pixels) : 0.0;
+}
+
+double pixelsPerSecond(uint64_t ns, uint64_t pixels)
+{
+	return ns > 0 ? double(pixels) * 1e9 / double(ns) : 0.0;
+}
+
+// JSON members with performance counters per pixel, null for counters that are not available.
+std::string countersJson(const PerfCounters* perf, const PerfCounterValues_t& values, uint64_t pixels)
+{
+	const char* names[] = { "instructions_per_pixel", "cycles_per_pixel", "branch_misses_per_pixel", "cache_misses_per_pixel" };
+	const uint64_t counts[] = { values.instructions, values.cycles, values.branch_misses, values.cache_misses };
+	std::string json;
+	for (int i = 0; i < 4; i++)
+	{
+		char buffer[128];
+		if (perf != NULL && perf->IsAvailable(i) && pixels > 0)
+			snprintf(buffer, sizeof(buffer), ", \"%s\": %.4f", names[i], double(counts[i]) / double(pixels));
+		else
+			snprintf(buffer, sizeof(buffer), ", \"%s\": null", names[i]);
+		json += buffer;
+	}
+	return json;
+}
+
+void printConsole(FILE* file, const std::vector<Result>& results, const PerfCounters* perf)
+{
+	fprintf(file, "%-36s %14s %12s %10s %14s", "Benchmark", "Time", "Pixels", "ns/pix", "pix/s");
+	if (perf != NULL)
+		fprintf(file, " %8s %8s %8s %8s", "ins/pix", "cyc/pix", "brm/pix", "cam/pix");
+	fprintf(file, "\n");
+
+	auto printCounters = [&](const PerfCounterValues_t& values, uint64_t pixels)
+	{
+		if (perf == NULL)
+			return;
+		const uint64_t counts[] = { values.instructions, values.cycles, values.branch_misses, values.cache_misses };
+		for (int i = 0; i < 4; i++)
+		{
+			if (perf->IsAvailable(i) && pixels > 0)
+				fprintf(file, " %8.2f", double(counts[i]) / double(pixels));
+			else
+				fprintf(file, " %8s", "-");
+		}
+	};
+
+	for (const Result& r : results)
+	{
+		fprintf(file, "%-36s %11llu ns %12llu %10.2f %14.0f", r.name().c_str(),
+			(unsigned long long)r.ns, (unsigned long long)r.pixels, nsPerPixel(r.ns, r.pixels), pixelsPerSecond(r.ns, r.pixels));
+		printCounters(r.counters, r.counted_pixels);
+		fprintf(file, "\n");
+		for (int bin = 0; bin < r.bin_ns.size(); bin++)
+		{
+			const uint64_t bin_ns = r.bin_ns.values[bin];
+			const uint64_t bin_pixels = r.bin_ns.counts[bin];
+			if (bin_pixels == 0)
+				continue;
+			fprintf(file, "  bin %2d (%6.0f) %31llu ns %12llu %10.2f", bin, logBinLargestInteger(bin),
+				(unsigned long long)bin_ns, (unsigned long long)bin_pixels, nsPerPixel(bin_ns, bin_pixels));
+			if (perf != NULL)
+				fprintf(file, " %14s", "");
+			printCounters(r.binCounters(bin), r.binCountedPixels(bin));
+			fprintf(file, "\n");
+		}
+	}
+}
+
+void printJson(FILE* file, const std::vector<Result>& results, const char* executable, const PerfCounters* perf)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"context\": {\n");
+	fprintf(file, "    \"executable\": \"%s\",\n", executable);
+	fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#ifdef NDEBUG
+	fprintf(file, "    \"library_build_type\": \"release\",\n");
+#else
+	fprintf(file, "    \"library_build_type\": \"debug\",\n");
+#endif
+	fprintf(file, "    \"opencv\": %s,\n", FECTS_BENCHMARK_OPENCV ? "true" : "false");
+	fprintf(file, "    \"perf_counters\": %s\n", perf != NULL ? "true" : "false");
+	fprintf(file, "  },\n");
+	fprintf(file, "  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& r = results[i];
+		fprintf(file, "    {\n");
+		fprintf(file, "      \"name\": \"%s\",\n", r.name().c_str());
+		fprintf(file, "      \"engine\": \"%s\",\n", r.engine.c_str());
+		fprintf(file, "      \"width\": %d,\n", r.width);
+		fprintf(file, "      \"height\": %d,\n", r.height);
+		fprintf(file, "      \"density\": %.2f,\n", r.density);
+		fprintf(file, "      \"repetitions\": %d,\n", r.repetitions);
+		fprintf(file, "      \"real_time\": %llu,\n", (unsigned long long)r.ns);
+		fprintf(file, "      \"time_unit\": \"ns\",\n");
+		fprintf(file, "      \"pixels\": %llu,\n", (unsigned long long)r.pixels);
+		fprintf(file, "      \"ns_per_pixel\": %.4f,\n", nsPerPixel(r.ns, r.pixels));
+		fprintf(file, "      \"pixels_per_second\": %.1f%s,\n", pixelsPerSecond(r.ns, r.pixels), countersJson(perf, r.counters, r.counted_pixels).c_str());
+		fprintf(file, "      \"bins\": [");
+		bool is_first = true;
+		for (int bin = 0; bin < r.bin_ns.size(); bin++)
+		{
+			const uint64_t bin_ns = r.bin_ns.values[bin];
+			const uint64_t bin_pixels = r.bin_ns.counts[bin];
+			if (bin_pixels == 0)
+				continue;
+			fprintf(file, "%s\n        { \"bin\": %d, \"upper_limit\": %.0f, \"real_time\": %llu, \"pixels\": %llu, \"ns_per_pixel\": %.4f%s }",
+				is_first ? "" : ",", bin, logBinLargestInteger(bin),
+				(unsigned long long)bin_ns, (unsigned long long)bin_pixels, nsPerPixel(bin_ns, bin_pixels),
+				countersJson(perf, r.binCounters(bin), r.binCountedPixels(bin)).c_str());
+			is_first = false;
+		}
+		fprintf(file, "%s]\n", is_first ? "" : "\n      ");
+		fprintf(file, "    }%s\n", i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+// Trace each contour from its start point and add the time to the bin of its length,
+// or the performance counters if perf is not NULL.
+template<typename TTrace>
+void traceContours(Result& result, const std::vector<std::vector<Point>>& contours, const std::vector<Links>& hierarchy, const PerfCounters* perf, TTrace trace)
+{
+	std::vector<Point> contour;
+	for (int i = 0; i < int(contours.size()); i++)
+	{
+		int level = 0;
+		for (int parent = hierarchy[i].parent; parent >= 0; parent = hierarchy[parent].parent)
+			++level;
+		const int dir = level % 2 == 0 ? 2 : 0;
+		const Point& start = contours[i][0];
+
+		contour.clear();
+		if (perf != NULL)
+		{
+			const PerfCounterValues_t counters_start = perf->Read();
+			trace(contour, start.x, start.y, dir);
+			result.add(logBin(double(contour.size())), perf->Read() - counters_start, contour.size());
+		}
+		else
+		{
+			const HighResolutionTime_t timer_start = GetHighResolutionTime();
+			trace(contour, start.x, start.y, dir);
+			result.add(logBin(double(contour.size())), GetHighResolutionTimeElapsedNs(timer_start), contour.size());
+		}
+
+		if (contour.size() != contours[i].size())
+			throw std::logic_error(result.engine + ": contour differs from findAllContours");
+	}
+}
+
+// Write rule hits [clockwise][dir][rule] as read by Generator.py --profile.
+void printRuleProfile(FILE* file, const FECTS::rule_profile_t& profile)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"rule_hits\": [\n");
+	for (int clockwise = 0; clockwise < 2; clockwise++)
+	{
+		fprintf(file, "    [\n");
+		for (int dir = 0; dir < 4; dir++)
+		{
+			const uint64_t* hits = profile.hits[clockwise][dir];
+			fprintf(file, "      [%llu, %llu, %llu, %llu]%s\n", (unsigned long long)hits[0], (unsigned long long)hits[1],
+				(unsigned long long)hits[2], (unsigned long long)hits[3], dir < 3 ? "," : "");
+		}
+		fprintf(file, "    ]%s\n", clockwise < 1 ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+// Process whole image and add the time to the bin of the image size, or the performance counters if perf is not NULL.
+// process returns the number of contour pixels.
+template<typename TProcess>
+void processImage(Result& result, int width, int height, const PerfCounters* perf, TProcess process)
+{
+	const int bin = logBin(double(width) * height);
+	if (perf != NULL)
+	{
+		const PerfCounterValues_t counters_start = perf->Read();
+		const size_t count = process();
+		result.add(bin, perf->Read() - counters_start, count);
+	}
+	else
+	{
+		const HighResolutionTime_t timer_start = GetHighResolutionTime();
+		const size_t count = process();
+		result.add(bin, GetHighResolutionTimeElapsedNs(timer_start), count);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* out_file_name = NULL;
+	bool is_json = false;
+	int repetitions = 3;
+	bool use_perf_counters = false;
+	const char* rule_profile_file_name = NULL;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (strncmp(arg, "--benchmark_out=", 16) == 0)
+			out_file_name = arg + 16;
+		else if (strcmp(arg, "--benchmark_format=json") == 0)
+			is_json = true;
+		else if (strcmp(arg, "--benchmark_format=console") == 0)
+			is_json = false;
+		else if (strncmp(arg, "--benchmark_repetitions=", 24) == 0)
+			repetitions = std::max(1, atoi(arg + 24));
+		else if (strcmp(arg, "--benchmark_perf_counters") == 0)
+			use_perf_counters = true;
+		else if (strncmp(arg, "--benchmark_rule_profile=", 25) == 0)
+			rule_profile_file_name = arg + 25;
+		else
+		{
+			fprintf(stderr, "usage: %s [--benchmark_out=<file>] [--benchmark_format=<console|json>] [--benchmark_repetitions=<n>] [--benchmark_perf_counters]"
+				" [--benchmark_rule_profile=<file>]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	if (rule_profile_file_name != NULL && !FECTS_PROFILE_RULES)
+	{
+		fprintf(stderr, "--benchmark_rule_profile needs FECTS_PROFILE_RULES=1, see ContourTracingProfile\n");
+		return 2;
+	}
+	FECTS::rule_profile_t rule_profile = {};
+
+	PerfCounters perf_counters;
+	const PerfCounters* perf = NULL;
+	if (use_perf_counters)
+	{
+		if (perf_counters.IsAvailable())
+			perf = &perf_counters;
+		else
+			fprintf(stderr, "Hardware performance counters are not available, e.g. check kernel.perf_event_paranoid.\n");
+	}
+
+	const int sizes[] = { 64, 256, 1024 };
+	const double densities[] = { 0.2, 0.35, 0.5 };
+
+	std::mt19937 random(471142);
+	std::vector<Result> results;
+
+	for (int size : sizes)
+	{
+		for (double density : densities)
+		{
+			const int width = size;
+			const int height = size;
+			std::vector<uint8_t> image(size_t(width) * height);
+			setRandom(image, width, height, density, random);
+
+			const int bitonal_stride = (width + 63) & ~63;
+			std::vector<uint64_t> bitonal_words(size_t(bitonal_stride) * height / 64 + 1, 0);
+			uint8_t* const bitonal = reinterpret_cast<uint8_t*>(bitonal_words.data());
+			for (int y = 0; y < height; y++)
+				for (int x = 0; x < width; x++)
+					if (image[x + y * width])
+						bitonal[size_t(x + y * bitonal_stride) >> 3] |= uint8_t(1 << ((x + y * bitonal_stride) & 7));
+
+			std::vector<std::vector<Point>> contours;
+			std::vector<Links> hierarchy;
+			FECTS::findAllContours(contours, hierarchy, image.data(), width, height, width, FECTS::RETR_TREE);
+
+			Result fects, fects_lut, fects_t, fects_b, fects_all, fects_b_all, opencv;
+			const char* names[] = { "FECTS", "FECTS_LUT", "FECTS_T", "FECTS_B", "FECTS_all", "FECTS_B_all", "OpenCV" };
+			Result* all[] = { &fects, &fects_lut, &fects_t, &fects_b, &fects_all, &fects_b_all, &opencv };
+			const int engine_count = int(sizeof(all) / sizeof(all[0]));
+			for (int i = 0; i < engine_count; i++)
+			{
+				all[i]->engine = names[i];
+				all[i]->width = width;
+				all[i]->height = height;
+				all[i]->density = density;
+				all[i]->repetitions = repetitions;
+			}
+
+			// timed repetitions, then one pass with performance counters
+			for (int repetition = 0; repetition < repetitions + (perf != NULL); repetition++)
+			{
+				const PerfCounters* counters = repetition < repetitions ? NULL : perf;
+
+				FECTS::ruleProfile() = FECTS::rule_profile_t();
+				traceContours(fects, contours, hierarchy, counters, [&](std::vector<Point>& contour, int x, int y, int dir)
+				{
+					FECTS::findContour(contour, image.data(), width, height, width, x, y, dir);
+				});
+				if (repetition == 0)
+				{
+					for (int i = 0; i < 2 * 4 * 4; i++)
+						(&rule_profile.hits[0][0][0])[i] += (&FECTS::ruleProfile().hits[0][0][0])[i];
+				}
+				traceContours(fects_lut, contours, hierarchy, counters, [&](std::vector<Point>& contour, int x, int y, int dir)
+				{
+					FECTS::findContour<false, false, false, false, true>(contour, image.data(), width, height, width, x, y, dir);
+				});
+				traceContours(fects_t, contours, hierarchy, counters, [&](std::vector<Point>& contour, int x, int y, int dir)
+				{
+					FECTS_T::findContour(contour, image.data(), width, height, width, 127, x, y, dir);
+				});
+				traceContours(fects_b, contours, hierarchy, counters, [&](std::vector<Point>& contour, int x, int y, int dir)
+				{
+					FECTS_B::findContour(contour, bitonal, width, height, bitonal_stride, x, y, dir);
+				});
+
+				// whole image including search for contour start points, binned by image size
+				processImage(fects_all, width, height, counters, [&]()
+				{
+					std::vector<std::vector<Point>> all_contours;
+					std::vector<Links> all_hierarchy;
+					FECTS::findAllContours(all_contours, all_hierarchy, image.data(), width, height, width, FECTS::RETR_TREE);
+					size_t count = 0;
+					for (const std::vector<Point>& contour : all_contours)
+						count += contour.size();
+					return count;
+				});
+
+				// same for a live 8-bit frame converted to 1 bit per pixel first
+				processImage(fects_b_all, width, height, counters, [&]()
+				{
+					BitonalImage<> frame(width, height);
+					frame.CopyFromThreshold(image.data(), width, height, width, 0);
+					std::vector<std::vector<Point>> all_contours;
+					std::vector<Links> all_hierarchy;
+					FECTS_B::findAllContours(all_contours, all_hierarchy, frame.data, frame.width, frame.height, frame.stride, FECTS_B::RETR_TREE);
+					size_t count = 0;
+					for (const std::vector<Point>& contour : all_contours)
+						count += contour.size();
+					return count;
+				});
+
+#if FECTS_BENCHMARK_OPENCV
+				processImage(opencv, width, height, counters, [&]()
+				{
+					cv::Mat cv_image(height, width, CV_8UC1, image.data());
+					std::vector<std::vector<cv::Point>> cv_contours;
+					std::vector<cv::Vec4i> cv_hierarchy;
+					cv::findContours(cv_image, cv_contours, cv_hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_NONE);
+					size_t count = 0;
+					for (const std::vector<cv::Point>& contour : cv_contours)
+						count += contour.size();
+					return count;
+				});
+#endif
+			}
+
+			for (int i = 0; i < engine_count; i++)
+			{
+				if (all[i]->pixels > 0)
+					results.push_back(*all[i]);
+			}
+		}
+	}
+
+	if (is_json)
+		printJson(stdout, results, argv[0], perf);
+	else
+		printConsole(stdout, results, perf);
+
+	if (out_file_name != NULL)
+	{
+		FILE* file = fopen(out_file_name, "w");
+		if (file == NULL)
+		{
+			fprintf(stderr, "can not write %s\n", out_file_name);
+			return 1;
+		}
+		printJson(file, results, argv[0], perf);
+		fclose(file);
+	}
+
+	if (rule_profile_file_name != NULL)
+	{
+		FILE* file = fopen(rule_profile_file_name, "w");
+		if (file == NULL)
+		{
+			fprintf(stderr, "can not write %s\n", rule_profile_file_name);
+			return 1;
+		}
+		printRuleProfile(file, rule_profile);
+		fclose(file);
+	}
+
+	return 0;
+}
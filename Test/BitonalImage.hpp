@@ -12,6 +12,17 @@
 #if defined(_WIN32) && IMAGE1BPP_USE_INTRINSICS
 #include <intrin.h>
 #endif
+// pack and unpack 16 pixels at once with SSE2 in CopyFrom, CopyTo, and IsEqual
+#ifndef IMAGE1BPP_USE_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGE1BPP_USE_SSE2 1
+#else
+#define IMAGE1BPP_USE_SSE2 0
+#endif
+#endif
+#if IMAGE1BPP_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 
 // A simple bitonal image format with 1 bit per pixel and optional padding at the end of lines
@@ -78,6 +89,96 @@ class BitonalImage
 			bits[bit_index >> 3] &= (uint8_t)~(1 << (bit_index & 7));
 	}
 
+	// Pack count <= 64 pixels with value above threshold into bits, pixel i into bit i.
+	static inline
+	uint64_t packPixels(const uint8_t* pixels, int count, int threshold)
+	{
+		uint64_t bits = 0;
+		int i = 0;
+#if IMAGE1BPP_USE_SSE2
+		if (0 <= threshold && threshold < 255)
+		{
+			// no unsigned byte compare in SSE2, so flip the sign bits and compare signed
+			const __m128i sign = _mm_set1_epi8(char(0x80));
+			const __m128i limit = _mm_set1_epi8(char(threshold ^ 0x80));
+			for (; i + 16 <= count; i += 16)
+			{
+				const __m128i values = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i)), sign);
+				bits |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(values, limit)))) << i;
+			}
+		}
+#endif
+		for (; i < count; i++)
+			bits |= uint64_t(pixels[i] > threshold) << i;
+		return bits;
+	}
+
+	// Unpack count <= 64 bits into pixels, bit i into pixel i with value foreground or 0.
+	static inline
+	void unpackPixels(uint8_t* pixels, int count, uint64_t bits, uint8_t foreground)
+	{
+		int i = 0;
+#if IMAGE1BPP_USE_SSE2
+		// spread each byte of bits to 8 bytes and select bit j of byte j
+		const __m128i select = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+		const __m128i value = _mm_set1_epi8(char(foreground));
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i spread = _mm_cvtsi32_si128(int((bits >> i) & 0xFFFF));
+			spread = _mm_unpacklo_epi8(spread, spread);
+			spread = _mm_unpacklo_epi16(spread, spread);
+			spread = _mm_unpacklo_epi32(spread, spread);
+			const __m128i is_set = _mm_cmpeq_epi8(_mm_and_si128(spread, select), select);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), _mm_and_si128(is_set, value));
+		}
+#endif
+		for (; i < count; i++)
+			pixels[i] = (bits >> i) & 1 ? foreground : 0;
+	}
+
+	// Load count <= 64 bits starting at bit_index.
+	static inline
+	uint64_t loadBits(const uint8_t* data, uint64_t bit_index, int count)
+	{
+		const uint8_t* byte = data + (bit_index >> 3);
+		const int shift = int(bit_index & 7);
+		const int byte_count = (shift + count + 7) >> 3;
+		uint64_t bits = 0;
+		for (int i = 0; i < byte_count && i < 8; i++)
+			bits |= uint64_t(byte[i]) << (i * 8);
+		bits >>= shift;
+		if (byte_count > 8)
+			bits |= uint64_t(byte[8]) << (64 - shift);
+		return count < 64 ? bits & ((uint64_t(1) << count) - 1) : bits;
+	}
+
+	// Store count <= 64 bits starting at bit_index, other bits of the bytes written are kept.
+	static inline
+	void storeBits(uint8_t* data, uint64_t bit_index, uint64_t bits, int count)
+	{
+		uint8_t* byte = data + (bit_index >> 3);
+		const int shift = int(bit_index & 7);
+		if (shift != 0)
+		{
+			const int n = std::min(8 - shift, count);
+			const uint8_t mask = uint8_t(((1 << n) - 1) << shift);
+			*byte = uint8_t((*byte & ~mask) | ((bits << shift) & mask));
+			++byte;
+			bits >>= n;
+			count -= n;
+		}
+		for (; count >= 8; count -= 8)
+		{
+			*byte++ = uint8_t(bits);
+			bits >>= 8;
+		}
+		if (count > 0)
+		{
+			const uint8_t mask = uint8_t((1 << count) - 1);
+			*byte = uint8_t((*byte & ~mask) | (bits & mask));
+		}
+	}
+
 public:
 	const int width = 0;
 	const int height = 0;
@@ -111,7 +212,15 @@ public:
 			SetPixelUnchecked(x, y, value);
 	}
 
-	void CopyFrom(uint8_t* image, int width, int height, int stride = 0)
+	// Set pixels with non-zero value in 8-bit image, see CopyFromThreshold.
+	void CopyFrom(const uint8_t* image, int width, int height, int stride = 0)
+	{
+		CopyFromThreshold(image, width, height, stride, 0);
+	}
+
+	// Set pixels with value above threshold in 8-bit image, and clear the others.
+	// Thresholding and packing is done in one pass, 64 pixels at a time, so no binary 8-bit image is needed for tracing with FECTS_B.
+	void CopyFromThreshold(const uint8_t* image, int width, int height, int stride, int threshold)
 	{
 		if (stride < width)
 			stride = width;
@@ -119,21 +228,55 @@ public:
 		width = std::min(width, this->width);
 		height = std::min(height, this->height);
 
-		// TBD: should this double-loop be optimized manually?
 		for (int y = 0; y < height; y++)
-			for (int x = 0; x < width; x++)
-				SetPixelUnchecked(x, y, image[y * stride + x] != 0);
+		{
+			const uint8_t* row = image + size_t(y) * size_t(stride);
+			const uint64_t bit_index = uint64_t(y) * uint64_t(this->stride);
+			for (int x = 0; x < width; x += 64)
+			{
+				const int count = std::min(64, width - x);
+				storeBits(data, bit_index + x, packPixels(row + x, count, threshold), count);
+			}
+		}
 	}
 
-	bool IsEqual(uint8_t* image, int width, int height, int stride = 0)
+	// Write foreground pixels as value foreground and background pixels as 0 into 8-bit image.
+	void CopyTo(uint8_t* image, int width, int height, int stride = 0, uint8_t foreground = 255) const
 	{
 		if (stride < width)
 			stride = width;
 
+		width = std::min(width, this->width);
+		height = std::min(height, this->height);
+
 		for (int y = 0; y < height; y++)
-			for (int x = 0; x < width; x++)
-				if ((GetPixelUnchecked(x, y) != 0) != (image[y * stride + x] != 0))
+		{
+			uint8_t* row = image + size_t(y) * size_t(stride);
+			const uint64_t bit_index = uint64_t(y) * uint64_t(this->stride);
+			for (int x = 0; x < width; x += 64)
+			{
+				const int count = std::min(64, width - x);
+				unpackPixels(row + x, count, loadBits(data, bit_index + x, count), foreground);
+			}
+		}
+	}
+
+	bool IsEqual(const uint8_t* image, int width, int height, int stride = 0) const
+	{
+		if (stride < width)
+			stride = width;
+
+		for (int y = 0; y < height; y++)
+		{
+			const uint8_t* row = image + size_t(y) * size_t(stride);
+			const uint64_t bit_index = uint64_t(y) * uint64_t(this->stride);
+			for (int x = 0; x < width; x += 64)
+			{
+				const int count = std::min(64, width - x);
+				if (packPixels(row + x, count, 0) != loadBits(data, bit_index + x, count))
 					return false;
+			}
+		}
 
 		return true;
 	}
@@ -0,0 +1,60 @@
+#pragma once
+//
+// Copyright 2024 Axel Walthelm
+//
+
+#include <stdint.h>
+#include <math.h>
+#include <limits>
+#include <vector>
+
+// Bins of logarithmic size used by Test.cpp and Benchmark.cpp to accumulate times by contour length.
+
+constexpr int logBinsMax = 711;  // logBin(std::numeric_limits<double>().max())+1
+
+// Bin of value, i.e. values up to logBinUpperLimit(bin) are in bin or below.
+inline int logBin(double value)
+{
+	if (value <= 1.0)
+		return 0;
+	if (std::isinf(value))
+		value = std::numeric_limits<double>().max();
+	return int(std::ceil(std::log(value)));
+}
+
+inline double logBinUpperLimit(int bin)
+{
+	if (bin < 0)
+		return 1.0;
+	return std::exp(double(bin));
+}
+
+// Largest integer in bin, e.g. the longest contour length, for printing the bin limit.
+inline double logBinLargestInteger(int bin)
+{
+	return std::floor(logBinUpperLimit(bin));
+}
+
+// Sum of values and of counts per bin, e.g. time and pixels of traced contours.
+template<typename TValue>
+struct LogBinSums
+{
+	std::vector<TValue> values;
+	std::vector<uint64_t> counts;
+
+	int size() const
+	{
+		return int(counts.size());
+	}
+
+	void add(int bin, const TValue& value, uint64_t count)
+	{
+		if (bin >= size())
+		{
+			values.resize(bin + 1, TValue());
+			counts.resize(bin + 1, 0);
+		}
+		values[bin] += value;
+		counts[bin] += count;
+	}
+};
@@ -0,0 +1,125 @@
+//
+// Copyright 2024 Axel Walthelm
+//
+
+#include "PerfCounters.h"
+
+PerfCounterValues_t& PerfCounterValues_t::operator+=(const PerfCounterValues_t& other)
+{
+	instructions += other.instructions;
+	cycles += other.cycles;
+	branch_misses += other.branch_misses;
+	cache_misses += other.cache_misses;
+	return *this;
+}
+
+PerfCounterValues_t PerfCounterValues_t::operator-(const PerfCounterValues_t& other) const
+{
+	PerfCounterValues_t difference;
+	difference.instructions = instructions - other.instructions;
+	difference.cycles = cycles - other.cycles;
+	difference.branch_misses = branch_misses - other.branch_misses;
+	difference.cache_misses = cache_misses - other.cache_misses;
+	return difference;
+}
+
+bool PerfCounters::IsAvailable() const
+{
+	return group_fd >= 0;
+}
+
+bool PerfCounters::IsAvailable(int counter_index) const
+{
+	return 0 <= counter_index && counter_index < counter_count && fds[counter_index] >= 0;
+}
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+
+PerfCounters::PerfCounters()
+{
+	const uint64_t configs[counter_count] = {
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+		PERF_COUNT_HW_CACHE_MISSES,
+	};
+
+	int count = 0;
+	for (int i = 0; i < counter_count; i++)
+	{
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.disabled = group_fd < 0 ? 1 : 0; // leader starts the group
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+
+		const int fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+		if (fd < 0)
+			continue;
+
+		if (group_fd < 0)
+			group_fd = fd;
+		fds[i] = fd;
+		read_index[i] = count++;
+	}
+
+	if (group_fd >= 0)
+	{
+		ioctl(group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+PerfCounters::~PerfCounters()
+{
+	for (int i = 0; i < counter_count; i++)
+	{
+		if (fds[i] >= 0)
+			close(fds[i]);
+	}
+}
+
+PerfCounterValues_t PerfCounters::Read() const
+{
+	PerfCounterValues_t values;
+	if (group_fd < 0)
+		return values;
+
+	uint64_t buffer[1 + counter_count] = { 0 }; // number of counters, then their values
+	if (read(group_fd, buffer, sizeof(buffer)) < ssize_t(sizeof(uint64_t)))
+		return values;
+
+	uint64_t* const counters[counter_count] = { &values.instructions, &values.cycles, &values.branch_misses, &values.cache_misses };
+	for (int i = 0; i < counter_count; i++)
+	{
+		if (read_index[i] >= 0 && uint64_t(read_index[i]) < buffer[0])
+			*counters[i] = buffer[1 + read_index[i]];
+	}
+	return values;
+}
+
+#else
+
+PerfCounters::PerfCounters()
+{
+}
+
+PerfCounters::~PerfCounters()
+{
+}
+
+PerfCounterValues_t PerfCounters::Read() const
+{
+	return PerfCounterValues_t();
+}
+
+#endif
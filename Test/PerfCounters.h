@@ -0,0 +1,43 @@
+#pragma once
+//
+// Copyright 2024 Axel Walthelm
+//
+
+#include <stdint.h>
+
+// Values of hardware performance counters, or differences of them.
+struct PerfCounterValues_t
+{
+	uint64_t instructions = 0;
+	uint64_t cycles = 0;
+	uint64_t branch_misses = 0;
+	uint64_t cache_misses = 0;
+
+	PerfCounterValues_t& operator+=(const PerfCounterValues_t& other);
+	PerfCounterValues_t operator-(const PerfCounterValues_t& other) const;
+};
+
+// Hardware performance counters of the calling thread in user space, opened with perf_event_open on Linux.
+// Counters that can't be opened (other OS, kernel.perf_event_paranoid too high, virtual machine without PMU, ...)
+// always read 0, so callers work the same with or without them.
+class PerfCounters
+{
+	enum { counter_count = 4 };
+	int group_fd = -1; // file descriptor of group leader, -1 if no counter is available
+	int fds[counter_count] = { -1, -1, -1, -1 }; // file descriptor of each counter, -1 if not available
+	int read_index[counter_count] = { -1, -1, -1, -1 }; // index of each counter in group read, -1 if not available
+
+public:
+	PerfCounters();
+	~PerfCounters();
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	// Indicates if any counter is available.
+	bool IsAvailable() const;
+
+	// Indicates which counters are available, in the order of PerfCounterValues_t.
+	bool IsAvailable(int counter_index) const;
+
+	PerfCounterValues_t Read() const;
+};
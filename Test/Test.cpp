@@ -2,8 +2,11 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 #include <vector>
+#include <stdexcept>
+#include <string.h>
 #include "BitonalImage.hpp"
 #include "HighResolutionTimer.h"
+#include "LogBins.hpp"
 
 #define SAVE_IMAGES 0
 #if SAVE_IMAGES
@@ -21,7 +24,7 @@ void TEST_ErrorHandler(const char* failed_expression, const char* error_message,
 		error_message = "FECTS_Assert failed";
 	if (!TEST_expects_error)
 		printf("%s: %s in function %s: %s(%d)\n", error_message, failed_expression, function_name, file_name, line_number);
-	throw std::exception(error_message);
+	throw std::runtime_error(error_message);
 	exit(-1);
 }
 #define FECTS_Assert(expr,msg) do { if(!!(expr)) ; else TEST_ErrorHandler(#expr, (msg), __func__, __FILE__, __LINE__ ); } while(0)
@@ -35,8 +38,19 @@ Other processors and architectures may benefit more from optimized code. (ARM, s
 #include "../ContourTracing.hpp"
 #include "../ContourTracingThresh.hpp"
 #include "../ContourTracingBitonal.hpp"
+#include "../ContourTracingThresh16.hpp"
+#include "../ContourTracingThreshFloat.hpp"
+#include "../ContourTracingRange.hpp"
+#include "../ContourTracingRange16.hpp"
+#include "../ContourTracingLabel32.hpp"
+#include "../ContourTracing4.hpp"
+#include "../ContourTracingThresh4.hpp"
 
 #include "../ContourChainApproxSimple.hpp"
+#include "../ContourChainCode.hpp"
+#include "../ContourCrackCode.hpp"
+#include "../ContourStatistics.hpp"
+#include "../ContourArena.hpp"
 
 static bool TEST_failed = false;
 
@@ -81,6 +95,25 @@ bool have_equal_items(std::vector<TData> const& vector1, std::vector<TData> cons
 	return true;
 }
 
+template <typename TData>
+bool is_cyclic_rotation(std::vector<TData> const& vector1, std::vector<TData> const& vector2)
+{
+	if (vector1.size() != vector2.size())
+		return false;
+
+	const size_t size = vector1.size();
+	for (size_t shift = 0; shift < size; shift++)
+	{
+		size_t i = 0;
+		while (i < size && vector1[i] == vector2[(i + shift) % size])
+			i++;
+		if (i == size)
+			return true;
+	}
+
+	return size == 0;
+}
+
 bool is_direct_neighbor_or_equal(cv::Point const& p1, cv::Point const& p2)
 {
 	int dx = std::abs(p1.x - p2.x);
@@ -115,6 +148,50 @@ void setPixel(cv::Mat& image, int x, int y, int value)
 	image.at<uint8_t>(y, x) = value;
 }
 
+// Reference of tracing the contour of a 4-connected object straight from the rules, without any optimization:
+// the forward-left pixel is only connected if the forward pixel is foreground too, see ContourTracing4.hpp.
+int traceContour4Connected(std::vector<cv::Point>& contour, const cv::Mat& image, int x, int y, int dir, bool clockwise)
+{
+	static const int dx[4] = { 0, 1, 0, -1 };
+	static const int dy[4] = { -1, 0, 1, 0 };
+	const int start_x = x;
+	const int start_y = y;
+	const int start_dir = dir;
+	int turns = 0;
+
+	do
+	{
+		const int left = (dir + (clockwise ? 3 : 1)) % 4;
+		if (getPixel(image, x + dx[dir], y + dy[dir], 0) == 0)
+		{
+			// turn right
+			dir = (dir + (clockwise ? 1 : 3)) % 4;
+			turns++;
+		}
+		else if (getPixel(image, x + dx[dir] + dx[left], y + dy[dir] + dy[left], 0) != 0)
+		{
+			// move to forward-left pixel and turn left
+			contour.emplace_back(x, y);
+			x += dx[dir] + dx[left];
+			y += dy[dir] + dy[left];
+			dir = left;
+			turns--;
+		}
+		else
+		{
+			// move ahead
+			contour.emplace_back(x, y);
+			x += dx[dir];
+			y += dy[dir];
+		}
+	} while (x != start_x || y != start_y || dir != start_dir);
+
+	if (contour.empty())
+		contour.emplace_back(x, y); // single isolated pixel
+
+	return turns;
+}
+
 void setRandom(cv::Mat& image,
 	const double seed_zero_probability = 0.65,
 	const double join_pixel_fraction = 0.5)
@@ -259,7 +336,7 @@ void TEST_show(cv::Mat& image, const std::vector<cv::Point>& contour, const std:
 	{
 		int status = _mkdir(save_path.c_str()); // must not exist - delete old folder before new run
 		if (status != 0)
-			throw std::exception("_mkdir failed");
+			throw std::runtime_error("_mkdir failed");
 	}
 
 #endif
@@ -288,7 +365,7 @@ void TEST_show(cv::Mat& image, const std::vector<cv::Point>& contour, const std:
 				cv::resize(display, display, cv::Size(), f, f, cv::INTER_NEAREST);
 			bool ok = cv::imwrite(save_path + string_format("\\image%05d.png", i + 1), display);
 			if (!ok)
-				throw std::exception("imwrite failed");
+				throw std::runtime_error("imwrite failed");
 #ifndef NDEBUG
 			cv::waitKey(100);
 #endif
@@ -303,51 +380,21 @@ void TEST_show(cv::Mat& image, const std::vector<cv::Point>& contour, const std:
 	}
 }
 
-constexpr int logBinsMax = 711;  // logBin(std::numeric_limits<double>().max())+1
-
-int logBin(double value)
-{
-	if (value <= 1.0)
-		return 0;
-	if (std::isinf(value))
-		value = std::numeric_limits<double>().max();
-	return int(std::ceil(std::log(value)));
-}
-
-double logBinUpperLimit(int bin)
+// Time and pixels of contours per bin of contour length.
+struct Durations : LogBinSums<uint64_t>
 {
-	if (bin < 0)
-		return 1.0;
-	return std::exp(double(bin));
-}
-
-
-struct Durations
-{
-	uint64_t bins[logBinsMax] = { 0 };
-	int counts[logBinsMax] = { 0 };
-
-	void add(int bin, uint64_t duration, int count)
-	{
-		bins[bin] += duration;
-		counts[bin] += count;
-	}
-
 	void print(const char* name, const char* name_other, uint64_t duration_other, int count_other)
 	{
 		uint64_t duration = 0;
 		int count = 0;
-		int max_bin = logBinsMax - 1;
-		while (max_bin >= 0 && counts[max_bin] == 0)
-			--max_bin;
-		for (int bin = 0; bin <= max_bin; bin++)
+		for (int bin = 0; bin < size(); bin++)
 		{
-			printf("%s  %d (%d): %lld ns, %d pix, %lld ns/pix\n",
+			printf("%s  %d (%.0f): %lld ns, %d pix, %lld ns/pix\n",
 				name,
-				bin, int(logBinUpperLimit(bin)), bins[bin], counts[bin],
-				bins[bin] / std::max(1, counts[bin]));
-			duration += bins[bin];
-			count += counts[bin];
+				bin, logBinLargestInteger(bin), values[bin], int(counts[bin]),
+				values[bin] / std::max<uint64_t>(1, counts[bin]));
+			duration += values[bin];
+			count += int(counts[bin]);
 		}
 		printf("time %8s: %11lld ns, %d pix, %lld ns/pix\n", name_other, duration_other, count_other, duration_other / count_other);
 		printf("time %8s: %11lld ns, %d pix, %lld ns/pix\n", name, duration, count, duration / count);
@@ -409,6 +456,12 @@ int main()
 			std::vector<cv::Point> contour;
 			TEST_ERROR(turns = FECTS::findContour(contour, image, 0, 0, -1, false, false), "image is empty");
 		}
+		{
+			cv::Mat image(0, 0, CV_8UC1);
+			std::vector<std::vector<cv::Point>> contours;
+			std::vector<cv::Vec4i> hierarchy;
+			TEST_ERROR(FECTS::findAllContours(contours, hierarchy, image, cv::RETR_TREE), "image is empty");
+		}
 	}
 
 	// seed pixel is outside of image
@@ -491,6 +544,28 @@ int main()
 		TEST(stop.y == 0);
 		TEST(turns == 4);
 
+		// compile-time specialization gives the same result
+		contour.clear();
+		stop = FECTS::stop_t();
+		TEST_NO_ERROR((turns = FECTS::findContour<false, true, false, false>(contour, image, 2, 0, -1, &stop)));
+		TEST(contour.size() == 2);
+		TEST(contour[0] == cv::Point(3, 0));
+		TEST(contour[1] == cv::Point(1, 0));
+		TEST(stop.max_contour_length == 4);
+		TEST(stop.dir == 1);
+		TEST(stop.x == 2);
+		TEST(stop.y == 0);
+		TEST(turns == 4);
+
+		// specialization needs to match stop
+		stop = FECTS::stop_t();
+		stop.max_contour_length = 2;
+		TEST_ERROR((turns = FECTS::findContour<false, true, false, false>(contour, image, 2, 0, -1, &stop)), "stop length does not match HasLengthLimit");
+		contour.clear();
+		TEST_NO_ERROR((turns = FECTS::findContour<false, true, false, true>(contour, image, 2, 0, -1, &stop)));
+		TEST(contour.size() == 1);
+		TEST(stop.max_contour_length == 2);
+
 		// suppress border clockwise gives the same result
 		contour.clear();
 		stop = FECTS::stop_t();
@@ -967,6 +1042,83 @@ int main()
 		}
 	}
 
+	// 4-connected objects
+	if (!TEST_failed)
+	{
+		// pixel (0,0) touches the other pixels only by a corner
+		cv::Mat image(3, 3, CV_8UC1, cv::Scalar(0));
+		setPixel(image, 0, 0, 255);
+		setPixel(image, 1, 1, 255);
+		setPixel(image, 2, 1, 255);
+		setPixel(image, 2, 2, 255);
+
+		// 8-connected it is one object
+		{
+			std::vector<cv::Point> contour;
+			TEST_NO_ERROR(turns = FECTS::findContour(contour, image, 0, 0, 2, false, false));
+			TEST(contour == std::vector<cv::Point>({ { 0, 0 }, { 1, 1 }, { 2, 2 }, { 2, 1 }, { 1, 1 } }));
+			TEST(turns == 4);
+		}
+
+		// 4-connected they are two objects
+		{
+			std::vector<cv::Point> contour;
+			TEST_NO_ERROR(turns = FECTS_4::findContour(contour, image, 0, 0, 2, false, false));
+			TEST(contour == std::vector<cv::Point>({ { 0, 0 } }));
+			TEST(turns == 4);
+		}
+		{
+			std::vector<cv::Point> contour;
+			TEST_NO_ERROR(turns = FECTS_4::findContour(contour, image, 1, 1, -1, false, false));
+			TEST(contour == std::vector<cv::Point>({ { 1, 1 }, { 2, 2 }, { 2, 1 } }));
+			TEST(turns == 4);
+		}
+		{
+			std::vector<cv::Point> contour;
+			TEST_NO_ERROR(turns = FECTS_T4::findContour(contour, image, 127, 1, 1, 1, true, false));
+			std::vector<cv::Point> expected_contour;
+			TEST(traceContour4Connected(expected_contour, image, 1, 1, 1, true) == turns);
+			TEST(contour == expected_contour);
+		}
+	}
+
+	// crack code
+	if (!TEST_failed)
+	{
+		cv::Mat image(3, 3, CV_8UC1, cv::Scalar(0));
+		setPixel(image, 0, 0, 255);
+		setPixel(image, 1, 1, 255);
+		setPixel(image, 2, 1, 255);
+		setPixel(image, 2, 2, 255);
+
+		// the edges pass the corner (1,1) twice, the area is the number of pixels
+		{
+			ContourCrackCode contour;
+			TEST_NO_ERROR(turns = FECTS::findContour(contour, image, 0, 0, 2, false, false));
+			std::vector<int> codes;
+			for (size_t i = 0; i < contour.size(); i++)
+				codes.push_back(contour.code(i));
+			std::vector<cv::Point> vertices;
+			for (const ContourCrackCode::Point& p : contour)
+				vertices.emplace_back(p.x, p.y);
+			TEST(codes == std::vector<int>({ 2, 1, 2, 1, 2, 1, 0, 0, 3, 3, 0, 3 }));
+			TEST(vertices == std::vector<cv::Point>({ { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 2 }, { 2, 2 }, { 2, 3 }, { 3, 3 }, { 3, 2 }, { 3, 1 }, { 2, 1 }, { 1, 1 }, { 1, 0 } }));
+			TEST(contour.closed());
+			TEST(contour.area(true) == -4);
+			TEST(turns == 4);
+		}
+
+		// an isolated pixel has 4 edges
+		{
+			ContourCrackCode contour;
+			TEST_NO_ERROR(turns = FECTS_4::findContour(contour, image, 0, 0, 2, false, false));
+			TEST(contour.size() == 4);
+			TEST(contour.closed());
+			TEST(contour.area() == 1);
+			TEST(turns == 4);
+		}
+	}
+
 	if (TEST_failed)
 	{
 		printf("TEST FAILED!\n");
@@ -981,8 +1133,10 @@ int main()
 	uint64_t duration_OpenCV = 0;
 	int duration_OpenCV_count = 0;
 	Durations duration_FECTS;
+	Durations duration_FECTS_LUT;
 	Durations duration_FECTS_T;
 	Durations duration_FECTS_B;
+	uint64_t duration_FECTS_all = 0;
 
 	for (int test = 0; test < 1000; test++)
 	{
@@ -994,6 +1148,18 @@ int main()
 		bitonal.CopyFrom(image.data, image.cols, image.rows, (int)image.step);
 		//bitonal.Print();
 		TEST(bitonal.IsEqual(image.data, image.cols, image.rows, (int)image.step));
+		BitonalImage<> thresholded(image.cols, image.rows, (int)image.step + 5);
+		thresholded.CopyFromThreshold(image.data, image.cols, image.rows, (int)image.step, 127);
+		TEST(thresholded.IsEqual(image.data, image.cols, image.rows, (int)image.step));
+		std::vector<uint8_t> unpacked(image.rows * image.step);
+		thresholded.CopyTo(unpacked.data(), image.cols, image.rows, (int)image.step);
+		for (int y = 0; y < image.rows; y++)
+			TEST(memcmp(unpacked.data() + y * image.step, image.ptr(y), image.cols) == 0);
+
+		// the same image with 16 bit and float pixels for variants "thresh16" and "threshfloat"
+		cv::Mat image_16u, image_32f;
+		image.convertTo(image_16u, CV_16U, 257);
+		image.convertTo(image_32f, CV_32F, 1.0 / 255);
 
 #if SAVE_IMAGES
 		cv::imwrite(string_format("C:\\tmp\\test-image-%05d.png", test), image);
@@ -1010,6 +1176,127 @@ int main()
 		printf("contours %d\n", int(contours.size()));
 		printf("hierarchy %dx4\n", int(hierarchy.size()));
 
+		// trace all contours like OpenCV, including search for contour start points
+		/////////////////////////////////////////////////////////////////////////////
+		{
+			std::vector<std::vector<cv::Point>> all_contours;
+			std::vector<cv::Vec4i> all_hierarchy;
+			timer_start = GetHighResolutionTime();
+			TEST_NO_ERROR(FECTS::findAllContours(all_contours, all_hierarchy, image, cv::RETR_TREE));
+			duration_FECTS_all += GetHighResolutionTimeElapsedNs(timer_start);
+
+			TEST(all_contours == contours);
+			TEST(all_hierarchy == hierarchy);
+
+			for (int mode: { cv::RETR_EXTERNAL, cv::RETR_LIST, cv::RETR_CCOMP })
+			{
+				std::vector<std::vector<cv::Point>> expected_contours;
+				std::vector<cv::Vec4i> expected_hierarchy;
+				cv::findContours(image, expected_contours, expected_hierarchy, mode, cv::CHAIN_APPROX_NONE);
+				TEST_NO_ERROR(FECTS::findAllContours(all_contours, all_hierarchy, image, mode));
+				TEST(all_contours == expected_contours);
+				TEST(all_hierarchy == expected_hierarchy);
+				if (TEST_failed)
+					printf("  mode=%d\n", mode);
+			}
+
+			// bands of 1 row give most seams, bands of height/3 rows give few
+			std::vector<std::vector<cv::Point>> expected_contours;
+			std::vector<cv::Vec4i> expected_hierarchy;
+			cv::findContours(image, expected_contours, expected_hierarchy, cv::RETR_LIST, cv::CHAIN_APPROX_NONE);
+			for (int band_height: { 1, std::max(1, image.rows / 3) })
+			{
+				TEST_NO_ERROR(FECTS::findAllContoursParallel(all_contours, all_hierarchy, image, 4, band_height));
+				TEST(all_contours == expected_contours);
+				TEST(all_hierarchy == expected_hierarchy);
+				if (TEST_failed)
+					printf("  band_height=%d\n", band_height);
+			}
+		}
+
+		// runs of foreground pixels of the raster scan
+		/////////////////////////////////////////////////
+		for (int y = 0; y < image.rows && !TEST_failed; y++)
+		{
+			const uint8_t* row = image.ptr(y);
+			int first = -1, last = -1, first_t = -1, last_t = -1, first_b = -1, last_b = -1, first_r = -1, last_r = -1;
+			int x = 0;
+			for (int expected_first = 0; expected_first < image.cols; expected_first++)
+			{
+				if (row[expected_first] == 0)
+					continue;
+				int expected_last = expected_first;
+				while (expected_last + 1 < image.cols && row[expected_last + 1] != 0)
+					++expected_last;
+
+				TEST(FECTS::findRowRun(first, last, image.data, image.cols, image.rows, (int)image.step, y, x));
+				TEST(first == expected_first && last == expected_last);
+				TEST(FECTS_T::findRowRun(first_t, last_t, image.data, image.cols, image.rows, (int)image.step, 127, y, x));
+				TEST(first_t == expected_first && last_t == expected_last);
+				TEST(FECTS_B::findRowRun(first_b, last_b, bitonal.data, bitonal.width, bitonal.height, bitonal.stride, y, x));
+				TEST(first_b == expected_first && last_b == expected_last);
+				TEST(FECTS_R::findRowRun(first_r, last_r, image.data, image.cols, image.rows, (int)image.step, 127, 255, y, x));
+				TEST(first_r == expected_first && last_r == expected_last);
+				if (TEST_failed)
+					printf("  y=%d x=%d\n", y, x);
+				x = expected_last + 1;
+				expected_first = expected_last;
+			}
+			TEST(!FECTS::findRowRun(first, last, image.data, image.cols, image.rows, (int)image.step, y, x));
+			TEST(!FECTS_T::findRowRun(first_t, last_t, image.data, image.cols, image.rows, (int)image.step, 127, y, x));
+			TEST(!FECTS_B::findRowRun(first_b, last_b, bitonal.data, bitonal.width, bitonal.height, bitonal.stride, y, x));
+			TEST(!FECTS_R::findRowRun(first_r, last_r, image.data, image.cols, image.rows, (int)image.step, 127, 255, y, x));
+		}
+
+		// outer contours of the connected components of a label image
+		///////////////////////////////////////////////////////////////
+		{
+			cv::Mat labels;
+			const int label_count = cv::connectedComponents(image, labels, 8, CV_32S);
+			std::vector<std::vector<cv::Point>> label_contours;
+			std::vector<int> label_ids;
+			TEST_NO_ERROR(FECTS_L32::findLabelContours(label_contours, label_ids, labels));
+			TEST(int(label_contours.size()) == label_count - 1);
+
+			std::vector<int> index_of_label(label_count, -1);
+			for (int i = 0; i < int(label_ids.size()) && !TEST_failed; i++)
+			{
+				TEST(0 < label_ids[i] && label_ids[i] < label_count);
+				if (!TEST_failed)
+					index_of_label[label_ids[i]] = i;
+			}
+
+			for (int contour_index = 0; contour_index < int(contours.size()) && !TEST_failed; contour_index++)
+			{
+				if (hierachy_level(hierarchy, contour_index) % 2 != 0)
+					continue; // hole
+
+				const cv::Point start = contours[contour_index][0];
+				const int index = index_of_label[labels.at<int>(start.y, start.x)];
+				TEST(index >= 0 && label_contours[index] == contours[contour_index]);
+				if (TEST_failed)
+					printf("  contour_index=%d\n", contour_index);
+			}
+
+			// labels near INT_MAX give the same contours
+			cv::Mat large_labels = labels.clone();
+			for (int y = 0; y < large_labels.rows; y++)
+				for (int x = 0; x < large_labels.cols; x++)
+					if (large_labels.at<int>(y, x) != 0)
+						large_labels.at<int>(y, x) += INT_MAX - label_count;
+			std::vector<std::vector<cv::Point>> large_label_contours;
+			std::vector<int> large_label_ids;
+			TEST_NO_ERROR(FECTS_L32::findLabelContours(large_label_contours, large_label_ids, large_labels));
+			TEST(large_label_contours == label_contours);
+			TEST(large_label_ids.size() == label_ids.size());
+			for (size_t i = 0; i < large_label_ids.size() && i < label_ids.size() && !TEST_failed; i++)
+				TEST(large_label_ids[i] == label_ids[i] + INT_MAX - label_count);
+		}
+
+		// image with a frame of background pixels for findContourFramed
+		cv::Mat framed_image;
+		cv::copyMakeBorder(image, framed_image, 1, 1, 1, 1, cv::BORDER_CONSTANT, cv::Scalar(0));
+
 		for (int contour_index = 0; contour_index < int(contours.size()); contour_index++)
 		{
 			std::vector<cv::Point> expected_contour = contours[contour_index];
@@ -1060,6 +1347,145 @@ int main()
 					break;
 			}
 
+			// trace from start point - lookup table engine
+			//////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				std::vector<cv::Point> contour;
+				int bin = logBin(double(expected_contour.size()));
+				timer_start = GetHighResolutionTime();
+				TEST_NO_ERROR((turns = FECTS::findContour<false, false, false, false, true>(contour, image, start.x, start.y, dir)));
+				duration_FECTS_LUT.add(bin, GetHighResolutionTimeElapsedNs(timer_start), int(expected_contour.size()));
+
+				TEST(contour.size() == expected_contour.size());
+				for (int i = 0; i < int(expected_contour.size()) && !TEST_failed; i++)
+				{
+					TEST(contour[i] == expected_contour[i]);
+					if (TEST_failed)
+						printf("  i=%d\n", i);
+				}
+
+				TEST(turns == (is_outer ? 4 : -4));
+
+				if (TEST_failed)
+					break;
+			}
+
+			// trace from start point - chain code
+			//////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				ContourChainCode contour;
+				TEST_NO_ERROR((turns = FECTS::findContour(contour, image, start.x, start.y, dir)));
+
+				TEST(contour.size() == expected_contour.size());
+				int i = 0;
+				for (const ContourChainCode::Point& p : contour)
+				{
+					if (i >= int(expected_contour.size()) || TEST_failed)
+						break;
+					TEST(cv::Point(p.x, p.y) == expected_contour[i]);
+					if (TEST_failed)
+						printf("  i=%d\n", i);
+					i++;
+				}
+
+				TEST(turns == (is_outer ? 4 : -4));
+
+				if (TEST_failed)
+					break;
+			}
+
+			// trace from start point - shape statistics
+			//////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				ContourStatistics<ContourArea, ContourPerimeter, ContourMoments, ContourBoundingBox> statistics;
+				TEST_NO_ERROR((turns = FECTS::findContour(statistics, image, start.x, start.y, dir)));
+
+				auto is_near = [](double a, double b) { return fabs(a - b) <= 1e-6 * std::max(1.0, fabs(b)); };
+				TEST(is_near(statistics.area(true), cv::contourArea(expected_contour, true)));
+				TEST(is_near(statistics.perimeter(), cv::arcLength(expected_contour, true)));
+				cv::Moments expected_moments = cv::moments(expected_contour);
+				ContourMoments::Moments moments = statistics.moments();
+				TEST(is_near(moments.m00, expected_moments.m00) && is_near(moments.m10, expected_moments.m10) && is_near(moments.m01, expected_moments.m01));
+				TEST(is_near(moments.mu20, expected_moments.mu20) && is_near(moments.mu11, expected_moments.mu11) && is_near(moments.mu02, expected_moments.mu02));
+				TEST(is_near(moments.nu30, expected_moments.nu30) && is_near(moments.nu21, expected_moments.nu21) && is_near(moments.nu12, expected_moments.nu12) && is_near(moments.nu03, expected_moments.nu03));
+				cv::Rect expected_box = cv::boundingRect(expected_contour);
+				ContourBoundingBox::Rect box = statistics.boundingBox();
+				TEST(cv::Rect(box.x, box.y, box.width, box.height) == expected_box);
+
+				if (TEST_failed)
+					break;
+			}
+
+			// trace from start point - crack code
+			//////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				ContourCrackCode contour;
+				std::vector<uint8_t> visited(image.rows * image.step, 0);
+				TEST_NO_ERROR((turns = FECTS::findContour(contour, image, start.x, start.y, dir, false, false, NULL, &visited[0])));
+
+				// one edge per visited bit, the edges are a closed polygon around the pixels
+				size_t edge_count = 0;
+				for (uint8_t bits : visited)
+					edge_count += (bits & 1) + (bits >> 1 & 1) + (bits >> 2 & 1) + (bits >> 3 & 1);
+				TEST(contour.size() == edge_count);
+				TEST(contour.closed());
+				TEST(contour.front().x == start.x + (is_outer ? 0 : 1) && contour.front().y == start.y + (is_outer ? 0 : 1));
+				// outer contours enclose the pixel centers, inner contours are enclosed by them
+				if (is_outer)
+					TEST(-contour.area(true) > fabs(cv::contourArea(expected_contour)));
+				else
+					TEST(contour.area(true) > 0);
+
+				int min_x = INT_MAX, min_y = INT_MAX, max_x = INT_MIN, max_y = INT_MIN;
+				for (const ContourCrackCode::Point& p : contour)
+				{
+					min_x = std::min(min_x, p.x);
+					min_y = std::min(min_y, p.y);
+					max_x = std::max(max_x, p.x);
+					max_y = std::max(max_y, p.y);
+				}
+				if (is_outer)
+					TEST(cv::Rect(min_x, min_y, max_x - min_x, max_y - min_y) == cv::boundingRect(expected_contour));
+				else
+					TEST(cv::Rect(min_x - 1, min_y - 1, max_x - min_x + 2, max_y - min_y + 2) == cv::boundingRect(expected_contour));
+
+				TEST(turns == (is_outer ? 4 : -4));
+
+				if (TEST_failed)
+					break;
+			}
+
+			// trace from start point - image with frame
+			//////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0] + cv::Point(1, 1);
+				int dir = is_outer ? 2 : 0;
+				bool clockwise = false;
+				std::vector<cv::Point> contour;
+				TEST_NO_ERROR(turns = FECTS::findContourFramed(contour, framed_image, start.x, start.y, dir, clockwise));
+
+				TEST(contour.size() == expected_contour.size());
+				for (int i = 0; i < int(expected_contour.size()) && !TEST_failed; i++)
+				{
+					TEST(contour[i] - cv::Point(1, 1) == expected_contour[i]);
+					if (TEST_failed)
+						printf("  i=%d\n", i);
+				}
+
+				TEST(turns == (is_outer ? 4 : -4));
+
+				if (TEST_failed)
+					break;
+			}
+
 			// trace from start point - variant "thresh"
 			//////////////////////////////////////////////
 			{
@@ -1089,6 +1515,194 @@ int main()
 					break;
 			}
 
+			// trace from start point - variants "thresh16" and "threshfloat"
+			//////////////////////////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				bool clockwise = false;
+				std::vector<cv::Point> contour_16u, contour_32f;
+				int turns_16u = 0, turns_32f = 0;
+				TEST_NO_ERROR(turns_16u = FECTS_T16::findContour(contour_16u, image_16u, 127 * 257, start.x, start.y, dir, clockwise));
+				TEST_NO_ERROR(turns_32f = FECTS_TF::findContour(contour_32f, image_32f, 0.5f, start.x, start.y, dir, clockwise));
+
+				TEST(contour_16u == expected_contour);
+				TEST(contour_32f == expected_contour);
+				TEST(turns_16u == (is_outer ? 4 : -4));
+				TEST(turns_32f == (is_outer ? 4 : -4));
+
+				if (TEST_showFailed(image, contour_16u == expected_contour ? contour_32f : contour_16u, expected_contour, contour_index))
+					break;
+			}
+
+			// trace from start point - variants "range" and "range16", with a range that has the foreground of image
+			//////////////////////////////////////////////////////////////////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				bool clockwise = false;
+				std::vector<cv::Point> contour_8u, contour_16u;
+				int turns_8u = 0, turns_16u = 0;
+				TEST_NO_ERROR(turns_8u = FECTS_R::findContour(contour_8u, image, 127, 255, start.x, start.y, dir, clockwise));
+				TEST_NO_ERROR(turns_16u = FECTS_R16::findContour(contour_16u, image_16u, 127 * 257, 65535, start.x, start.y, dir, clockwise));
+
+				TEST(contour_8u == expected_contour);
+				TEST(contour_16u == expected_contour);
+				TEST(turns_8u == (is_outer ? 4 : -4));
+				TEST(turns_16u == (is_outer ? 4 : -4));
+
+				if (TEST_showFailed(image, contour_8u == expected_contour ? contour_16u : contour_8u, expected_contour, contour_index))
+					break;
+			}
+
+			// trace from start point - variants for 4-connected objects, compared with the reference implementation
+			///////////////////////////////////////////////////////////////////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				bool clockwise = rand_int(1) == 1;
+				int dir = ((is_outer ? 2 : 0) + (clockwise ? 2 : 0)) % 4; // same start edge
+				std::vector<cv::Point> expected_contour_4;
+				int expected_turns_4 = traceContour4Connected(expected_contour_4, image, start.x, start.y, dir, clockwise);
+				TEST(expected_turns_4 == 4 || expected_turns_4 == -4);
+
+				std::vector<cv::Point> contour, contour_lut, contour_t, contour_framed;
+				int turns_lut = 0, turns_t = 0, turns_framed = 0;
+				TEST_NO_ERROR(turns = FECTS_4::findContour(contour, image, start.x, start.y, dir, clockwise));
+				TEST_NO_ERROR((turns_lut = clockwise
+					? FECTS_4::findContour<true, false, false, false, true>(contour_lut, image, start.x, start.y, dir)
+					: FECTS_4::findContour<false, false, false, false, true>(contour_lut, image, start.x, start.y, dir)));
+				TEST_NO_ERROR(turns_t = FECTS_T4::findContour(contour_t, image, 127, start.x, start.y, dir, clockwise));
+				TEST_NO_ERROR(turns_framed = FECTS_4::findContourFramed(contour_framed, framed_image, start.x + 1, start.y + 1, dir, clockwise));
+				for (cv::Point& p : contour_framed)
+					p = p - cv::Point(1, 1);
+
+				TEST(contour == expected_contour_4);
+				TEST(contour_lut == expected_contour_4);
+				TEST(contour_t == expected_contour_4);
+				TEST(contour_framed == expected_contour_4);
+				TEST(turns == expected_turns_4 && turns_lut == expected_turns_4 && turns_t == expected_turns_4 && turns_framed == expected_turns_4);
+
+				if (TEST_showFailed(image, contour == expected_contour_4 ? contour_t : contour, expected_contour_4, contour_index))
+					break;
+			}
+
+			// trace from start point with stop predicates
+			////////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				bool clockwise = false;
+				cv::Rect box = cv::boundingRect(expected_contour);
+				std::vector<cv::Point> contour;
+				FECTS_T::stop_t stop;
+				FECTS_T::StopAtBoundingBox fitting_box(box.width, box.height);
+				TEST_NO_ERROR(turns = FECTS_T::findContour(contour, image, 127, start.x, start.y, dir, clockwise, false, &stop, NULL, fitting_box));
+				TEST(contour == expected_contour);
+				TEST(stop.reason == FECTS_T::STOP_CLOSED);
+				TEST(turns == (is_outer ? 4 : -4));
+
+				// a box one pixel smaller or a rectangle one pixel smaller stops at the first pixel outside of it
+				contour.clear();
+				stop = FECTS_T::stop_t();
+				bool test_box = rand_int(1) == 1;
+				int reason = test_box ? FECTS_T::STOP_AT_BOUNDING_BOX : FECTS_T::STOP_OUTSIDE_RECTANGLE;
+				FECTS_T::StopAtBoundingBox smaller_box(box.width - 1, box.height);
+				FECTS_T::StopOutsideRectangle smaller_rectangle(box.x, box.y, box.width, box.height - 1);
+				if (test_box)
+					TEST_NO_ERROR(FECTS_T::findContour(contour, image, 127, start.x, start.y, dir, clockwise, false, &stop, NULL, smaller_box));
+				else
+					TEST_NO_ERROR(FECTS_T::findContour(contour, image, 127, start.x, start.y, dir, clockwise, false, &stop, NULL, smaller_rectangle));
+				TEST(stop.reason == reason);
+				TEST(stop.max_contour_length == int(contour.size()));
+				TEST(contour.size() < expected_contour.size());
+				TEST(std::equal(contour.begin(), contour.end(), expected_contour.begin()));
+				TEST(stop.x == expected_contour[contour.size() % expected_contour.size()].x && stop.y == expected_contour[contour.size() % expected_contour.size()].y);
+
+				// findContourFramed has no stop predicate, but sets the reason like findContour
+				const int max_contour_length = 1 + rand_int(int(expected_contour.size()));
+				contour.clear();
+				stop = FECTS_T::stop_t();
+				stop.max_contour_length = max_contour_length;
+				TEST_NO_ERROR(FECTS_T::findContour(contour, image, 127, start.x, start.y, dir, clockwise, false, &stop));
+				std::vector<cv::Point> contour_framed;
+				FECTS_T::stop_t stop_framed;
+				stop_framed.max_contour_length = max_contour_length;
+				TEST_NO_ERROR(FECTS_T::findContourFramed(contour_framed, framed_image, 127, start.x + 1, start.y + 1, dir, clockwise, &stop_framed));
+				for (cv::Point& p : contour_framed)
+					p = p - cv::Point(1, 1);
+				TEST(contour_framed == contour);
+				TEST(stop_framed.reason == stop.reason);
+				TEST(stop_framed.reason == (contour.size() < expected_contour.size() ? FECTS_T::STOP_AT_LENGTH : stop.reason));
+				TEST(stop_framed.max_contour_length == stop.max_contour_length);
+				TEST(stop_framed.x - 1 == stop.x && stop_framed.y - 1 == stop.y && stop_framed.dir == stop.dir);
+
+				if (TEST_showFailed(image, contour, expected_contour, contour_index))
+					break;
+			}
+
+			// trace from start point in steps - ContourTracer
+			///////////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				bool clockwise = false;
+				std::vector<cv::Point> contour;
+				int count = 1 + rand_int(99);
+				int steps = 0;
+				bool is_done = false;
+				FECTS_T::ContourTracer tracer(image, 127, start.x, start.y, dir, clockwise);
+				do
+				{
+					++steps;
+					TEST_NO_ERROR(is_done = tracer.trace(contour, count));
+					TEST(int(contour.size()) == std::min(steps * count, int(expected_contour.size())));
+				} while (!is_done && !TEST_failed);
+
+				TEST(contour == expected_contour);
+				TEST(tracer.sumOfTurns() == (is_outer ? 4 : -4));
+
+				// same as findContour with the other arguments too, which is tested above
+				std::vector<cv::Point> traced_contour, found_contour;
+				int found_turns = 0;
+				bool other_clockwise = rand_int(1) == 1;
+				bool do_suppress_border = rand_int(1) == 1;
+				FECTS_T::ContourTracer other_tracer(image, 127, start.x, start.y, -1, other_clockwise, do_suppress_border);
+				TEST_NO_ERROR(while (!other_tracer.trace(traced_contour, count)) {});
+				TEST_NO_ERROR(found_turns = FECTS_T::findContour(found_contour, image, 127, start.x, start.y, -1, other_clockwise, do_suppress_border));
+
+				TEST(traced_contour == found_contour);
+				TEST(other_tracer.sumOfTurns() == found_turns);
+
+				if (TEST_showFailed(image, contour == expected_contour ? traced_contour : contour, contour == expected_contour ? found_contour : expected_contour, contour_index))
+					break;
+			}
+
+			// trace fragment around start point - findContourFragment
+			/////////////////////////////////////////////////////////////
+			{
+				cv::Point start = expected_contour[0];
+				int dir = is_outer ? 2 : 0;
+				bool clockwise = false;
+				std::vector<cv::Point> contour;
+				int count = rand_int(1) == 1 ? rand_int(9) : rand_int(999);
+				int start_index = -1;
+				TEST_NO_ERROR(start_index = FECTS_T::findContourFragment(contour, image, 127, start.x, start.y, count, dir, clockwise));
+
+				// pixels before the start point are at the end of expected_contour
+				int length = int(expected_contour.size());
+				int fragment_length = std::min(length, 2 * count + 1);
+				int before = length <= 2 * count + 1 ? fragment_length / 2 : count;
+				std::vector<cv::Point> expected_fragment;
+				for (int i = -before; i < fragment_length - before; i++)
+					expected_fragment.push_back(expected_contour[(i + length) % length]);
+
+				TEST(start_index == before);
+				TEST(contour == expected_fragment);
+
+				if (TEST_showFailed(image, contour, expected_fragment, contour_index))
+					break;
+			}
+
 			// trace from start point - variant "bitonal"
 			//////////////////////////////////////////////
 			{
@@ -1203,6 +1817,80 @@ int main()
 			}
 		}
 
+		// trace contours of many seeds, but each contour only once
+		/////////////////////////////////////////////////////////////
+		{
+			std::vector<cv::Point> seeds;
+			for (const std::vector<cv::Point>& contour: contours)
+				seeds.insert(seeds.end(), contour.begin(), contour.end());
+
+			std::vector<std::vector<cv::Point>> seed_contours;
+			std::vector<int> contour_indices;
+			TEST_NO_ERROR(FECTS::findContours(seed_contours, contour_indices, seeds, image));
+			TEST(contour_indices.size() == seeds.size());
+			TEST(seed_contours.size() <= contours.size());
+
+			for (int i = 0; i < int(seeds.size()) && !TEST_failed; i++)
+			{
+				TEST(0 <= contour_indices[i] && contour_indices[i] < int(seed_contours.size()));
+				if (TEST_failed)
+					break;
+				const std::vector<cv::Point>& seed_contour = seed_contours[contour_indices[i]];
+				TEST(is_contained(seeds[i], seed_contour));
+				if (i % 7 == 0)
+				{
+					std::vector<cv::Point> contour;
+					TEST_NO_ERROR(FECTS::findContour(contour, image, seeds[i].x, seeds[i].y));
+					TEST(is_cyclic_rotation(contour, seed_contour));
+				}
+				if (TEST_failed)
+					printf("  seed=%d\n", i);
+			}
+		}
+
+		// trace contours of seeds in parallel
+		////////////////////////////////////////
+		{
+			std::vector<cv::Point> seeds;
+			for (const std::vector<cv::Point>& contour: contours)
+				seeds.push_back(contour[0]);
+
+			std::vector<std::vector<cv::Point>> parallel_contours;
+			TEST_NO_ERROR(FECTS::findContoursParallel(parallel_contours, seeds, image, -1, false, 4));
+			TEST(parallel_contours.size() == seeds.size());
+
+			for (int i = 0; i < int(seeds.size()) && !TEST_failed; i++)
+			{
+				std::vector<cv::Point> contour;
+				TEST_NO_ERROR(FECTS::findContour(contour, image, seeds[i].x, seeds[i].y));
+				TEST(parallel_contours[i] == contour);
+				if (TEST_failed)
+					printf("  seed=%d\n", i);
+			}
+		}
+
+		// trace contours of seeds into an arena
+		////////////////////////////////////////
+		{
+			std::vector<cv::Point> seeds;
+			for (const std::vector<cv::Point>& contour: contours)
+				seeds.push_back(contour[0]);
+
+			ContourArena<cv::Point> arena(4 * size_t(image.cols) * size_t(image.rows), seeds.size());
+			TEST_NO_ERROR(FECTS::findContoursParallel(arena, seeds, image, -1, false, 4));
+			TEST(arena.size() == seeds.size());
+
+			for (int i = 0; i < int(seeds.size()) && !TEST_failed; i++)
+			{
+				std::vector<cv::Point> contour;
+				TEST_NO_ERROR(FECTS::findContour(contour, image, seeds[i].x, seeds[i].y));
+				ContourSpan<cv::Point> span = arena[i];
+				TEST(std::vector<cv::Point>(span.begin(), span.end()) == contour);
+				if (TEST_failed)
+					printf("  seed=%d\n", i);
+			}
+		}
+
 		// test cv::CHAIN_APPROX_SIMPLE
 		//////////////////////////////////
 		contours.clear();
@@ -1269,9 +1957,15 @@ int main()
 			time ratio: 0.638
 		*/
 
+		duration_FECTS_LUT.print("FECTS_LUT", "OpenCV", duration_OpenCV, duration_OpenCV_count);
 		duration_FECTS_T.print("FECTS_T", "OpenCV", duration_OpenCV, duration_OpenCV_count);
 		duration_FECTS_B.print("FECTS_B", "OpenCV", duration_OpenCV, duration_OpenCV_count);
 
+		// whole image including search for contour start points
+		printf("time %8s: %11lld ns, %d pix, %lld ns/pix\n", "OpenCV", duration_OpenCV, duration_OpenCV_count, duration_OpenCV / duration_OpenCV_count);
+		printf("time %8s: %11lld ns, %d pix, %lld ns/pix\n", "FECTS_all", duration_FECTS_all, duration_OpenCV_count, duration_FECTS_all / duration_OpenCV_count);
+		printf("time ratio: %.3f\n", double(duration_FECTS_all) / double(duration_OpenCV));
+
 		if (TEST_failed)
 			break;
 	}
@@ -1281,6 +1975,6 @@ int main()
 	else
 		printf("TEST OK\n");
 
-	return 0;
+	return TEST_failed ? -1 : 0;
 }
 